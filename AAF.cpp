@@ -1,20 +1,316 @@
 #include "AAF.h"
+#include "mapped_file.h"
+#include "bitset.h"
+
 #include <iostream>
+#include <cstring>
 #include <vector>
 #include <algorithm>
 #include <unordered_set>
 
-AttackRelation::AttackRelation(AAF &aaf)
-  : arg_cnt (aaf.args.size()), atters(aaf.args.size()), atteds(aaf.args.size()) {
-  for(Attack att:aaf.atts) {
-    atters[att.passive.id].push_back(att.active.id);
-    atteds[att.active.id].push_back(att.passive.id);
-    if (att.active.id == att.passive.id)
-      self_atters.push_back(att.active.id);
+AttackRelation::AttackRelation(const AAF &aaf)
+  : AttackRelation(aaf.args.size(), aaf.atts) {}
+
+AttackRelation::AttackRelation(int arg_cnt, const std::vector<Attack> &atts)
+  : arg_cnt (arg_cnt) {
+  build(atts);
+}
+
+AttackRelation::AttackRelation(int arg_cnt, const std::uint64_t *atter_offsets, const arg_t *atters,
+    const std::uint64_t *atted_offsets, const arg_t *atteds, std::shared_ptr<MappedFile> mapping)
+  : mapping(mapping), atter_begin(atter_offsets), atter_end(atter_offsets + 1),
+    atted_begin(atted_offsets), atted_end(atted_offsets + 1), atters(atters), atteds(atteds),
+    att_cnt(atted_offsets[arg_cnt]), arg_cnt (arg_cnt) {
+  for (arg_t i = 0; i < arg_cnt; i++) {
+    auto range = attacked_set(i);
+    if (std::binary_search(range.begin(), range.end(), i))
+      self_atters.push_back(i);
+  }
+}
+
+AttackRelation::AttackRelation(const AttackRelation &other)
+  : offset_store(other.offset_store), neighbour_store(other.neighbour_store), mapping(other.mapping),
+    atter_begin(other.atter_begin), atter_end(other.atter_end),
+    atted_begin(other.atted_begin), atted_end(other.atted_end), atters(other.atters), atteds(other.atteds),
+    att_cnt(other.att_cnt), self_atters(other.self_atters), atter_rows(other.atter_rows),
+    atted_rows(other.atted_rows), changeable(other.changeable), changes(other.changes),
+    atter_bits(other.atter_bits), atted_bits(other.atted_bits), bit_words(other.bit_words),
+    arg_cnt(other.arg_cnt), analysis(other.analysis) {
+  if (!mapping)
+    point_to_store();
+}
+
+void AttackRelation::point_to_store() {
+  if (changeable) {
+    atted_begin = atted_rows.begin.data();
+    atted_end = atted_rows.end.data();
+    atter_begin = atter_rows.begin.data();
+    atter_end = atter_rows.end.data();
+    atteds = atters = neighbour_store.data();
+    return;
+  }
+  const std::size_t n = arg_cnt;
+  atted_begin = offset_store.data();
+  atted_end = atted_begin + 1;
+  atter_begin = offset_store.data() + n + 1;
+  atter_end = atter_begin + 1;
+  atteds = neighbour_store.data();
+  atters = neighbour_store.data() + atted_begin[n];
+}
+
+void AttackRelation::make_changeable() {
+  if (changeable)
+    return;
+  std::vector<arg_t> store;
+  store.reserve(2 * att_cnt);
+  auto copy_rows = [this, &store](Rows &rows, bool attackers) {
+    rows.begin.resize(arg_cnt);
+    rows.end.resize(arg_cnt);
+    rows.capacity.resize(arg_cnt);
+    for (arg_t i = 0; i < arg_cnt; i++) {
+      const ArgRange range = attackers ? attacker_set(i) : attacked_set(i);
+      rows.begin[i] = store.size();
+      store.insert(store.end(), range.begin(), range.end());
+      rows.end[i] = store.size();
+      rows.capacity[i] = range.size();
+    }
+  };
+  copy_rows(atted_rows, false);
+  copy_rows(atter_rows, true);
+  neighbour_store.swap(store);
+  std::vector<std::uint64_t>().swap(offset_store);
+  mapping.reset();
+  changeable = true;
+  point_to_store();
+}
+
+void AttackRelation::invalidate() {
+  analysis = AnalysisCache();
+  std::vector<std::uint64_t>().swap(atter_bits);
+  std::vector<std::uint64_t>().swap(atted_bits);
+  bit_words = 0;
+  point_to_store();
+}
+
+void AttackRelation::insert(Rows &rows, arg_t row, arg_t val) {
+  const std::uint64_t len = rows.end[row] - rows.begin[row];
+  if (len == rows.capacity[row]) {
+    const std::uint64_t begin = neighbour_store.size(), capacity = std::max<std::uint64_t>(4, 2 * len);
+    neighbour_store.resize(begin + capacity);
+    std::copy(neighbour_store.begin() + rows.begin[row], neighbour_store.begin() + rows.end[row],
+      neighbour_store.begin() + begin);
+    rows.begin[row] = begin;
+    rows.end[row] = begin + len;
+    rows.capacity[row] = capacity;
   }
+  arg_t * const first = neighbour_store.data() + rows.begin[row], * const last = first + len;
+  arg_t * const pos = std::lower_bound(first, last, val);
+  std::copy_backward(pos, last, last + 1);
+  *pos = val;
+  rows.end[row]++;
+}
+
+bool AttackRelation::erase(Rows &rows, arg_t row, arg_t val) {
+  arg_t * const first = neighbour_store.data() + rows.begin[row],
+    * const last = neighbour_store.data() + rows.end[row];
+  arg_t * const pos = std::lower_bound(first, last, val);
+  if (pos == last || *pos != val)
+    return false;
+  std::copy(pos + 1, last, pos);
+  rows.end[row]--;
+  return true;
+}
+
+/**
+ * Replaces a neighbour by one with a lower id, which is moved to its sorted position
+ */
+void AttackRelation::rename(Rows &rows, arg_t row, arg_t from, arg_t to) {
+  arg_t * const first = neighbour_store.data() + rows.begin[row],
+    * const last = neighbour_store.data() + rows.end[row];
+  arg_t * const pos = std::lower_bound(first, last, from);
+  *pos = to;
+  std::rotate(std::lower_bound(first, pos, to), pos, pos + 1);
+}
+
+arg_t AttackRelation::add_argument() {
+  make_changeable();
+  for (Rows *rows : {&atter_rows, &atted_rows}) {
+    rows->begin.push_back(neighbour_store.size());
+    rows->end.push_back(neighbour_store.size());
+    rows->capacity.push_back(0);
+  }
+  changes.push_back(arg_cnt);
+  arg_cnt++;
+  invalidate();
+  return arg_cnt - 1;
+}
+
+arg_t AttackRelation::remove_argument(arg_t arg) {
+  make_changeable();
+  const ArgRange atted_range = attacked_set(arg), atter_range = attacker_set(arg);
+  const std::vector<arg_t> arg_atteds (atted_range.begin(), atted_range.end()),
+    arg_atters (atter_range.begin(), atter_range.end());
+  for (arg_t atted : arg_atteds)
+    remove_attack(arg, atted);
+  for (arg_t atter : arg_atters)
+    if (atter != arg)
+      remove_attack(atter, arg);
+
+  const arg_t last = arg_cnt - 1;
+  if (arg != last) {
+    for (Rows *rows : {&atter_rows, &atted_rows}) {
+      rows->begin[arg] = rows->begin[last];
+      rows->end[arg] = rows->end[last];
+      rows->capacity[arg] = rows->capacity[last];
+    }
+    point_to_store();
+    auto self = std::lower_bound(self_atters.begin(), self_atters.end(), last);
+    if (self != self_atters.end() && *self == last) {
+      rename(atted_rows, arg, last, arg);
+      rename(atter_rows, arg, last, arg);
+      self_atters.erase(self);
+      self_atters.insert(std::lower_bound(self_atters.begin(), self_atters.end(), arg), arg);
+    }
+    for (arg_t atted : attacked_set(arg))
+      if (atted != arg) {
+        rename(atter_rows, atted, last, arg);
+        changes.push_back(atted);
+      }
+    for (arg_t atter : attacker_set(arg))
+      if (atter != arg)
+        rename(atted_rows, atter, last, arg);
+    changes.push_back(arg);
+  }
+  for (Rows *rows : {&atter_rows, &atted_rows}) {
+    rows->begin.pop_back();
+    rows->end.pop_back();
+    rows->capacity.pop_back();
+  }
+  arg_cnt--;
+  invalidate();
+  return last;
+}
+
+bool AttackRelation::add_attack(arg_t atter, arg_t atted) {
+  make_changeable();
+  const ArgRange range = attacked_set(atter);
+  if (std::binary_search(range.begin(), range.end(), atted))
+    return false;
+  insert(atted_rows, atter, atted);
+  insert(atter_rows, atted, atter);
+  if (atter == atted)
+    self_atters.insert(std::lower_bound(self_atters.begin(), self_atters.end(), atter), atter);
+  att_cnt++;
+  changes.push_back(atted);
+  invalidate();
+  return true;
+}
+
+bool AttackRelation::remove_attack(arg_t atter, arg_t atted) {
+  make_changeable();
+  if (!erase(atted_rows, atter, atted))
+    return false;
+  erase(atter_rows, atted, atter);
+  if (atter == atted)
+    self_atters.erase(std::lower_bound(self_atters.begin(), self_atters.end(), atter));
+  att_cnt--;
+  changes.push_back(atted);
+  invalidate();
+  return true;
+}
+
+void AttackRelation::build_bitsets() {
+  bit_words = bits::words(arg_cnt);
+  const std::size_t row_cnt = (std::size_t)arg_cnt * bit_words;
+  atter_bits.assign(row_cnt, 0);
+  atted_bits.assign(row_cnt, 0);
+  for (arg_t i = 0; i < arg_cnt; i++)
+    for (arg_t atted : attacked_set(i)) {
+      bits::insert(&atted_bits[(std::size_t)i * bit_words], atted);
+      bits::insert(&atter_bits[(std::size_t)atted * bit_words], i);
+    }
+}
+
+/**
+ * Builds both adjacency arrays with counting sort. The attacked sets are built first,
+ * sorted and compacted, the attacker sets are then obtained by transposing them in
+ * order, which keeps them sorted as well.
+ */
+void AttackRelation::build(const std::vector<Attack> &atts) {
+  const std::size_t n = arg_cnt;
+  offset_store.assign(2 * (n + 1), 0);
+  std::uint64_t *out = offset_store.data(), *in = offset_store.data() + n + 1;
+
+  for (const Attack &att : atts)
+    out[att.active + 1]++;
+  for (std::size_t i = 0; i < n; i++)
+    out[i + 1] += out[i];
+  std::vector<arg_t> fill (atts.size());
+  {
+    std::vector<std::uint64_t> pos (out, out + n);
+    for (const Attack &att : atts)
+      fill[pos[att.active]++] = att.passive;
+  }
+
+  std::uint64_t cnt = 0;
+  for (std::size_t i = 0; i < n; i++) {
+    arg_t * const first = fill.data() + out[i], * const last = fill.data() + out[i + 1];
+    std::sort(first, last);
+    arg_t * const unique_end = std::unique(first, last);
+    out[i] = cnt;
+    for (arg_t *p = first; p < unique_end; p++) {
+      fill[cnt++] = *p;
+      in[*p + 1]++;
+      if (*p == (arg_t)i)
+        self_atters.push_back(i);
+    }
+  }
+  out[n] = cnt;
+  att_cnt = cnt;
+  fill.resize(cnt);
+  fill.shrink_to_fit();
+
+  for (std::size_t i = 0; i < n; i++)
+    in[i + 1] += in[i];
+  neighbour_store.resize(2 * cnt);
+  std::copy(fill.begin(), fill.end(), neighbour_store.begin());
+  std::vector<arg_t>().swap(fill);
+  arg_t * const transposed = neighbour_store.data() + cnt;
+  std::vector<std::uint64_t> pos (in, in + n);
+  for (std::size_t i = 0; i < n; i++)
+    for (std::uint64_t j = out[i]; j < out[i + 1]; j++)
+      transposed[pos[neighbour_store[j]]++] = i;
+
+  point_to_store();
+}
+
+arg_t AAF::add_argument(const std::string &label) {
+  const std::size_t base = source ? source->size() : 0;
+  Argument arg = {(int)args.size(), base + label_store.size(), (int)label.size()};
+  label_store += label;
+  args.push_back(arg);
+  return arg.id;
+}
+
+const char * AAF::label_data(const Argument &arg) const {
+  const std::size_t base = source ? source->size() : 0;
+  if (arg.label_offset < base)
+    return source->begin() + arg.label_offset;
+  return label_store.data() + (arg.label_offset - base);
+}
+
+arg_t AAF::find(const std::string &label) const {
+  for (auto &arg : args) {
+    if (arg.label_len == label.size()
+        && !std::memcmp(label_data(arg), label.data(), label.size()))
+      return arg.id;
+  }
+  return -1;
 }
 
 void AAF::print(std::vector<int> ext, std::ostream &str) {
+  if (origin.size())
+    std::sort(ext.begin(), ext.end(), [this](arg_t a, arg_t b) {return origin[a] < origin[b];});
   str << '[';
   bool first = true;
   for (int i : ext) {
@@ -22,24 +318,20 @@ void AAF::print(std::vector<int> ext, std::ostream &str) {
       first = false;
     else
       str << ',';
-    str << args[i];
+    str.write(label_data(args[i]), args[i].label_len);
   }
   str << ']';
 }
 
 void AAF::todot(std::ostream &str) {
   str << "digraph G {\n";
-  for (auto arg : args)
-    str << arg.label<< ";\n";
-  for (auto att : atts)
-    str << att.active.label << " -> " << att.passive.label << ";\n";
+  for (auto &arg : args)
+    str << label(arg.id) << ";\n";
+  for (auto &att : atts)
+    str << label(att.active) << " -> " << label(att.passive) << ";\n";
   str << "}";
 }
 
-std::ostream& operator <<(std::ostream& stream, const Argument& arg) {
-  stream << arg.label;
-}
-
 bool operator==(const Argument &x, const Argument &y)  {
   return x.id == y.id;
 }
@@ -50,21 +342,23 @@ bool operator!=(const Argument &x, const Argument &y) {
 
 std::ostream& operator <<(std::ostream& stream, const Attack& att) {
   stream << att.active << " -> " << att.passive;
+  return stream;
 }
 
 bool operator==(const Attack &x, const Attack &y)  {
-  return x.active.id == y.active.id && x.passive.id == y.passive.id;
+  return x.active == y.active && x.passive == y.passive;
 }
 
 bool operator!=(const Attack &x, const Attack &y) {
-  return x.active.id != y.active.id || x.passive.id != y.passive.id;
+  return x.active != y.active || x.passive != y.passive;
 }
 
 std::ostream& operator <<(std::ostream& stream, const AAF& aaf) {
   for (auto &arg : aaf.args)
-    stream << arg << ", ";
+    stream << aaf.label(arg.id) << ", ";
   stream <<"\n";
   for (auto &att : aaf.atts)
-    stream << att << ", ";
+    stream << aaf.label(att.active) << " -> " << aaf.label(att.passive) << ", ";
   stream <<"\n";
+  return stream;
 }
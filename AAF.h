@@ -1,20 +1,28 @@
 #include <ostream>
+#include <string>
 #include <vector>
+#include <memory>
+#include <map>
+#include <cstdint>
 
 #pragma once
 
 typedef int arg_t;
 
+class MappedFile;
+
 /**
  * Stores information about an argument
  */
 struct Argument {
   int id;
-  std::string label;
+  /**
+   * the label is stored only once in the label buffer of the AAF
+   */
+  std::size_t label_offset;
+  int label_len;
 };
 
-std::ostream& operator <<(std::ostream& stream, const Argument& arg) ;
-
 bool operator==(const Argument &x, const Argument &y)  ;
 
 bool operator!=(const Argument &x, const Argument &y) ;
@@ -23,7 +31,7 @@ bool operator!=(const Argument &x, const Argument &y) ;
  * Represents an attack
  */
 struct Attack {
-  Argument active, passive;
+  arg_t active, passive;
 };
 
 std::ostream& operator <<(std::ostream& stream, const Attack& att) ;
@@ -38,6 +46,41 @@ bool operator!=(const Attack &x, const Attack &y) ;
 struct AAF {
   std::vector<Argument> args;
   std::vector<Attack> atts;
+  /**
+   * The mapped source file, labels with an offset below its size point into it
+   */
+  std::shared_ptr<MappedFile> source;
+  /**
+   * Holds all labels which are not part of the source file
+   */
+  std::string label_store;
+  /**
+   * The id every argument had in the source file, empty unless the arguments were
+   * renumbered
+   */
+  std::vector<arg_t> origin;
+  /**
+   * Appends a new argument whose label is copied into the label store
+   * @param  label the label of the argument
+   * @return       the id of the argument
+   */
+  arg_t add_argument(const std::string &label);
+  /**
+   * @param  arg an argument
+   * @return     a pointer to its label, which is not null-terminated
+   */
+  const char * label_data(const Argument &arg) const;
+  /**
+   * @param  arg an argument id
+   * @return     a copy of its label
+   */
+  inline std::string label(arg_t arg) const {return std::string(label_data(args[arg]), args[arg].label_len);}
+  /**
+   * Looks up an argument by its label in linear time
+   * @param  label the label
+   * @return       the id of the argument or -1 if there is none
+   */
+  arg_t find(const std::string &label) const;
   void print(std::vector<int> ext, std::ostream &str);
   void todot(std::ostream &str);
 };
@@ -45,46 +88,217 @@ struct AAF {
 std::ostream& operator <<(std::ostream& stream, const AAF& aaf) ;
 
 /**
- * Neighbourhood-centric representation of an AAF
+ * Results of analyses of an AAF which were computed beforehand, e.g. stored in a
+ * binary file, and may be reused instead of being recomputed
+ */
+struct AnalysisCache {
+  /**
+   * the grounded extension, only valid if has_grounded is set
+   */
+  bool has_grounded = false;
+  std::vector<arg_t> grounded;
+  /**
+   * the SCC of every argument as computed by Tarjan's algorithm, empty if unknown
+   */
+  std::vector<int> sccs;
+  /**
+   * sorted orders of static heuristics by the expressions they were parsed from
+   */
+  std::map<std::string, std::vector<std::pair<int,double>>> orders;
+};
+
+/**
+ * A read-only view of a contiguous range of arguments
+ */
+class ArgRange {
+  const arg_t *first, *last;
+public:
+  ArgRange(const arg_t *first, const arg_t *last) : first(first), last(last) {}
+  inline const arg_t * begin() const {return first;}
+  inline const arg_t * end() const {return last;}
+  inline const arg_t * data() const {return first;}
+  inline std::size_t size() const {return last - first;}
+  inline bool empty() const {return first == last;}
+  inline arg_t operator[](std::size_t i) const {return first[i];}
+};
+
+/**
+ * Neighbourhood-centric representation of an AAF. Attackers and attacked arguments
+ * are stored in compressed sparse row format, i.e. the neighbours of all arguments
+ * are stored in one array and the neighbours of argument i are found between the
+ * positions offsets[i] and offsets[i+1]. Every neighbourhood is sorted and free of
+ * duplicates.
+ * Arguments and attacks can be added and removed, which invalidates the cached
+ * analyses and bitsets. The AAF the relation was created from is not changed.
  */
 class AttackRelation {
-   std::vector<std::vector<int>> atters, atteds;
+   /**
+    * owns the offsets and neighbours unless they lie within a mapped file
+    */
+   std::vector<std::uint64_t> offset_store;
+   std::vector<arg_t> neighbour_store;
+   std::shared_ptr<MappedFile> mapping;
+   /**
+    * the neighbours of argument i lie between begin[i] and end[i], in compressed
+    * sparse row format end points to the entry of begin which follows
+    */
+   const std::uint64_t *atter_begin, *atter_end, *atted_begin, *atted_end;
+   const arg_t *atters, *atteds;
+   std::uint64_t att_cnt;
    std::vector<arg_t> self_atters;
+   /**
+    * Once the relation is changed, every neighbourhood lies at its own position
+    * within neighbour_store and is followed by spare capacity. Neighbourhoods which
+    * outgrow their capacity are moved to the end of neighbour_store.
+    */
+   struct Rows {
+     std::vector<std::uint64_t> begin, end, capacity;
+   } atter_rows, atted_rows;
+   bool changeable = false;
+   /**
+    * arguments whose attackers changed, in the order of the changes
+    */
+   std::vector<arg_t> changes;
+   /**
+    * optional bitset representation of the attackers and attacked arguments, one
+    * row of bit_words words per argument
+    */
+   std::vector<std::uint64_t> atter_bits, atted_bits;
+   int bit_words = 0;
+
+   void build(const std::vector<Attack> &atts);
+   void point_to_store();
+   void make_changeable();
+   void invalidate();
+   void insert(Rows &rows, arg_t row, arg_t val);
+   bool erase(Rows &rows, arg_t row, arg_t val);
+   void rename(Rows &rows, arg_t row, arg_t from, arg_t to);
  public:
    /**
-    * the number of arguments in the AAF
+    * the number of arguments in the AAF, only changed by add_argument and
+    * remove_argument
     */
-   const int arg_cnt;
+   int arg_cnt;
+   /**
+    * precomputed results which algorithms may use instead of recomputing them
+    */
+   AnalysisCache analysis;
    /**
     * Creates an AttackRelation according to an AAF
     */
-   AttackRelation(AAF &aaf);
+   AttackRelation(const AAF &aaf);
+   /**
+    * Creates an AttackRelation from attacks between argument ids
+    * @param arg_cnt the number of arguments
+    * @param atts    the attacks, which may contain duplicates
+    */
+   AttackRelation(int arg_cnt, const std::vector<Attack> &atts);
+   /**
+    * Creates an AttackRelation which refers to sorted adjacency lists without
+    * duplicates in compressed sparse row format within a mapped file
+    * @param arg_cnt       the number of arguments
+    * @param atter_offsets offsets into atters
+    * @param atters        the attackers of all arguments
+    * @param atted_offsets offsets into atteds
+    * @param atteds        the arguments attacked by all arguments
+    * @param mapping       the file which contains the arrays
+    */
+   AttackRelation(int arg_cnt, const std::uint64_t *atter_offsets, const arg_t *atters,
+      const std::uint64_t *atted_offsets, const arg_t *atteds, std::shared_ptr<MappedFile> mapping);
+   AttackRelation(const AttackRelation &other);
+   AttackRelation& operator=(const AttackRelation&) = delete;
    /**
     * Maps an argument a to its attacker set {a}^-
     * @param  arg an argument
     * @return     the set of attackers
     */
-   inline const std::vector<int> &  attacker_set(int i) const {return atters[i];}
+   inline ArgRange attacker_set(int i) const {return ArgRange(atters + atter_begin[i], atters + atter_end[i]);}
    /**
     * Maps an argument a to the set of arguments attacked by it {a}^+
     * @param  arg an argument
     * @return     the set of attacked arguments
     */
-   inline const std::vector<int> &  attacked_set(int i) const {return atteds[i];}
+   inline ArgRange attacked_set(int i) const {return ArgRange(atteds + atted_begin[i], atteds + atted_end[i]);}
    /**
     * Maps an argument to its indegree
     * @param  arg an argument
     * @return     the indegree deg^-(arg)
     */
-   inline int indegree(int arg) const {return atters[arg].size();}
+   inline int indegree(int arg) const {return atter_end[arg] - atter_begin[arg];}
    /**
     * Maps an argument to its outdegree
     * @param  arg an argument
     * @return     the outdegree deg^+(arg)
     */
-   inline int outdegree(int arg) const {return atteds[arg].size();}
+   inline int outdegree(int arg) const {return atted_end[arg] - atted_begin[arg];}
+   /**
+    * @return the number of attacks without duplicates
+    */
+   inline std::uint64_t attack_cnt() const {return att_cnt;}
    /**
     * @return the set of arguments which attack themselves {a in A | a -> a}
     */
    inline const std::vector<arg_t> & self_attacker_set() const {return self_atters;}
+   /**
+    * Appends an argument without any attacks
+    * @return the id of the new argument
+    */
+   arg_t add_argument();
+   /**
+    * Removes an argument along with its attacks. The argument with the highest id
+    * takes over its id, so that ids remain contiguous.
+    * @param  arg an argument
+    * @return     the former id of the argument which now has the id arg, which is arg
+    *             itself if it had the highest id
+    */
+   arg_t remove_argument(arg_t arg);
+   /**
+    * Adds an attack
+    * @param  atter the attacking argument
+    * @param  atted the attacked argument
+    * @return       false iff the attack already existed
+    */
+   bool add_attack(arg_t atter, arg_t atted);
+   /**
+    * Removes an attack
+    * @param  atter the attacking argument
+    * @param  atted the attacked argument
+    * @return       false iff there was no such attack
+    */
+   bool remove_attack(arg_t atter, arg_t atted);
+   /**
+    * @return the arguments whose attackers changed in the order of the changes, ids
+    *         refer to the current numbering and are not valid anymore if they exceed
+    *         arg_cnt
+    */
+   inline const std::vector<arg_t> & changed_args() const {return changes;}
+   /**
+    * Additionally stores attackers and attacked arguments as bitsets (see bitset.h),
+    * which allows algorithms to process whole neighbourhoods word-parallel
+    */
+   void build_bitsets();
+   /**
+    * @return true iff bitsets were built
+    */
+   inline bool has_bitsets() const {return bit_words > 0;}
+   /**
+    * @return the number of words of a bitset over all arguments
+    */
+   inline int bitset_words() const {return bit_words;}
+   /**
+    * @param  arg an argument
+    * @return     the set of attackers as bitset, only available if bitsets were built
+    */
+   inline const std::uint64_t * attacker_bits(int arg) const {return atter_bits.data() + (std::size_t)arg * bit_words;}
+   /**
+    * @param  arg an argument
+    * @return     the set of attacked arguments as bitset, only available if bitsets
+    *             were built
+    */
+   inline const std::uint64_t * attacked_bits(int arg) const {return atted_bits.data() + (std::size_t)arg * bit_words;}
+   /**
+    * Decides whether the AAF is dense enough that bitsets do not take more memory
+    * than the adjacency lists, i.e. there are at least n^2/32 attacks
+    */
+   inline bool is_dense() const {return 32 * attack_cnt() >= (std::uint64_t)arg_cnt * arg_cnt;}
 };
@@ -11,7 +11,7 @@ void populateAdjacencyMatrix (Eigen::SparseMatrix<entry_t>&A, AAF&aaf, entry_t v
   std::vector<Eigen::Triplet<entry_t>> tripletList(aaf.atts.size());
   for(auto&att:aaf.atts)
   {
-    tripletList.push_back(Eigen::Triplet<entry_t>(att.active.id, att.passive.id,val));
+    tripletList.push_back(Eigen::Triplet<entry_t>(att.active, att.passive,val));
   }
   A.setFromTriplets(tripletList.begin(), tripletList.end());
 }
@@ -0,0 +1,287 @@
+#include "binary.h"
+#include "mapped_file.h"
+
+#include <fstream>
+#include <functional>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+  const char magic[8] = {'H', 'E', 'U', 'R', 'E', 'K', 'A', '\0'};
+  const std::uint32_t version = 2;
+
+  namespace sections {
+    constexpr std::uint32_t
+      LABELS = 1,
+      ATTACKERS = 2,
+      ATTACKED = 3,
+      GROUNDED = 4,
+      SCCS = 5,
+      ORDER = 6;
+  }
+
+  struct Header {
+    char magic[8];
+    std::uint32_t version, section_cnt;
+    std::uint64_t arg_cnt, att_cnt;
+  };
+
+  struct Section {
+    std::uint32_t type, reserved;
+    std::uint64_t offset, size;
+  };
+
+  struct OrderEntry {
+    std::int32_t arg, reserved;
+    double val;
+  };
+
+  inline std::uint64_t padded(std::uint64_t size) {
+    return (size + 7) & ~(std::uint64_t)7;
+  }
+
+  /**
+   * A section which is yet to be written
+   */
+  struct PendingSection {
+    std::uint32_t type;
+    std::uint64_t size;
+    std::function<void(std::ostream&)> write;
+  };
+
+  template<class T>
+  inline void put(std::ostream &out, const T &val) {
+    out.write(reinterpret_cast<const char*>(&val), sizeof(T));
+  }
+
+  /**
+   * Creates a section which stores adjacency lists in compressed sparse row format
+   */
+  PendingSection adjacency_section(std::uint32_t type, const AttackRelation &ar, bool attackers) {
+    auto neighbours = [&ar, attackers](arg_t arg) {
+      return attackers ? ar.attacker_set(arg) : ar.attacked_set(arg);
+    };
+    std::uint64_t cnt = 0;
+    for (arg_t i = 0; i < ar.arg_cnt; i++)
+      cnt += neighbours(i).size();
+    return PendingSection {type, 8 * (std::uint64_t)(ar.arg_cnt + 1) + 4 * cnt,
+      [&ar, neighbours](std::ostream &out) {
+        std::uint64_t offset = 0;
+        put(out, offset);
+        for (arg_t i = 0; i < ar.arg_cnt; i++)
+          put(out, offset += neighbours(i).size());
+        for (arg_t i = 0; i < ar.arg_cnt; i++)
+          out.write(reinterpret_cast<const char*>(neighbours(i).data()), 4 * neighbours(i).size());
+      }};
+  }
+}
+
+bool writeBinary(const std::string &path, const AAF &aaf, const AttackRelation &ar) {
+  const int n = ar.arg_cnt;
+  std::vector<PendingSection> pending;
+
+  std::uint64_t label_bytes = 0;
+  for (auto &arg : aaf.args)
+    label_bytes += arg.label_len;
+  pending.push_back(PendingSection {sections::LABELS, 8 * (std::uint64_t)(n + 1) + label_bytes,
+    [&](std::ostream &out) {
+      std::uint64_t offset = 0;
+      put(out, offset);
+      for (auto &arg : aaf.args)
+        put(out, offset += arg.label_len);
+      for (auto &arg : aaf.args)
+        out.write(aaf.label_data(arg), arg.label_len);
+    }});
+  pending.push_back(adjacency_section(sections::ATTACKERS, ar, true));
+  pending.push_back(adjacency_section(sections::ATTACKED, ar, false));
+
+  const AnalysisCache &analysis = ar.analysis;
+  if (analysis.has_grounded)
+    pending.push_back(PendingSection {sections::GROUNDED, 4 * analysis.grounded.size(),
+      [&](std::ostream &out) {
+        out.write(reinterpret_cast<const char*>(analysis.grounded.data()), 4 * analysis.grounded.size());
+      }});
+  if (analysis.sccs.size() == n)
+    pending.push_back(PendingSection {sections::SCCS, 4 * (std::uint64_t)n,
+      [&](std::ostream &out) {
+        out.write(reinterpret_cast<const char*>(analysis.sccs.data()), 4 * n);
+      }});
+  for (auto &entry : analysis.orders) {
+    const std::string &expression = entry.first;
+    const auto &order = entry.second;
+    pending.push_back(PendingSection {sections::ORDER,
+      8 + padded(expression.size()) + sizeof(OrderEntry) * order.size(),
+      [&](std::ostream &out) {
+        put(out, (std::uint64_t)expression.size());
+        out.write(expression.data(), expression.size());
+        out.write("\0\0\0\0\0\0\0", padded(expression.size()) - expression.size());
+        for (auto &p : order)
+          put(out, OrderEntry {p.first, 0, p.second});
+      }});
+  }
+
+  std::ofstream out (path, std::ios::binary);
+  if (!out.is_open())
+    return false;
+
+  Header header;
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.version = version;
+  header.section_cnt = pending.size();
+  header.arg_cnt = n;
+  header.att_cnt = aaf.atts.size();
+  put(out, header);
+
+  std::uint64_t offset = sizeof(Header) + sizeof(Section) * pending.size();
+  for (auto &section : pending) {
+    put(out, Section {section.type, 0, offset, section.size});
+    offset += padded(section.size);
+  }
+  for (auto &section : pending) {
+    section.write(out);
+    out.write("\0\0\0\0\0\0\0", padded(section.size) - section.size);
+  }
+  return out.good();
+}
+
+AttackRelation * loadBinary(AAF &aaf, const std::string &path) {
+  std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(path);
+  if (!file->is_open() || file->size() < sizeof(Header))
+    return nullptr;
+  const char * const base = file->begin();
+  const Header &header = *reinterpret_cast<const Header*>(base);
+  if (std::memcmp(header.magic, magic, sizeof(magic)) || header.version != version
+      || sizeof(Header) + sizeof(Section) * (std::uint64_t)header.section_cnt > file->size())
+    return nullptr;
+  const std::uint64_t n = header.arg_cnt;
+  if (n >= file->size())
+    return nullptr;
+  const Section * const table = reinterpret_cast<const Section*>(base + sizeof(Header));
+
+  const Section *labels = nullptr, *attackers = nullptr, *attacked = nullptr;
+  for (std::uint32_t i = 0; i < header.section_cnt; i++) {
+    const Section &section = table[i];
+    if (section.offset % 8 || section.offset > file->size() || section.size > file->size() - section.offset)
+      return nullptr;
+    if (section.type == sections::LABELS)
+      labels = &section;
+    else if (section.type == sections::ATTACKERS)
+      attackers = &section;
+    else if (section.type == sections::ATTACKED)
+      attacked = &section;
+  }
+  if (!labels || !attackers || !attacked)
+    return nullptr;
+
+  auto offsets_of = [base](const Section *section) {
+    return reinterpret_cast<const std::uint64_t*>(base + section->offset);
+  };
+  /**
+   * Checks that offsets are monotonic and stay within their section
+   */
+  auto check_offsets = [n, offsets_of](const Section *section, std::uint64_t entry_size) {
+    if (section->size < 8 * (n + 1))
+      return false;
+    const std::uint64_t available = (section->size - 8 * (n + 1)) / entry_size;
+    const std::uint64_t *offsets = offsets_of(section);
+    for (std::uint64_t i = 0; i < n; i++)
+      if (offsets[i] > offsets[i+1])
+        return false;
+    return offsets[0] == 0 && offsets[n] <= available;
+  };
+  if (!check_offsets(labels, 1) || !check_offsets(attackers, 4) || !check_offsets(attacked, 4))
+    return nullptr;
+
+  const std::uint64_t *atter_offsets = offsets_of(attackers), *atted_offsets = offsets_of(attacked);
+  const arg_t *atters = reinterpret_cast<const arg_t*>(base + attackers->offset + 8 * (n + 1)),
+    *atteds = reinterpret_cast<const arg_t*>(base + attacked->offset + 8 * (n + 1));
+  /**
+   * Checks that neighbourhoods are sorted, free of duplicates and within bounds
+   */
+  auto check_neighbours = [n](const std::uint64_t *offsets, const arg_t *neighbours) {
+    for (std::uint64_t i = 0; i < n; i++)
+      for (std::uint64_t j = offsets[i]; j < offsets[i+1]; j++)
+        if (neighbours[j] < 0 || neighbours[j] >= (arg_t)n
+            || (j > offsets[i] && neighbours[j-1] >= neighbours[j]))
+          return false;
+    return true;
+  };
+  if (!check_neighbours(atter_offsets, atters) || !check_neighbours(atted_offsets, atteds))
+    return nullptr;
+  /**
+   * Checks that both halves store the same attacks, as they hold equally many
+   * attacks it suffices to find every attack of one half in the other
+   */
+  if (atter_offsets[n] != atted_offsets[n])
+    return nullptr;
+  for (std::uint64_t i = 0; i < n; i++)
+    for (std::uint64_t j = atted_offsets[i]; j < atted_offsets[i+1]; j++) {
+      const arg_t target = atteds[j];
+      if (!std::binary_search(atters + atter_offsets[target], atters + atter_offsets[target+1], (arg_t)i))
+        return nullptr;
+    }
+
+  const std::uint64_t *label_offsets = offsets_of(labels);
+  const std::uint64_t label_base = labels->offset + 8 * (n + 1);
+  aaf.source = file;
+  aaf.args.reserve(n);
+  for (std::uint64_t i = 0; i < n; i++)
+    aaf.args.push_back(Argument {(int)i, label_base + label_offsets[i],
+      (int)(label_offsets[i+1] - label_offsets[i])});
+
+  aaf.atts.reserve(atted_offsets[n]);
+  for (std::uint64_t i = 0; i < n; i++)
+    for (std::uint64_t j = atted_offsets[i]; j < atted_offsets[i+1]; j++)
+      aaf.atts.push_back(Attack {(arg_t)i, atteds[j]});
+
+  AttackRelation *ar = new AttackRelation(n, atter_offsets, atters, atted_offsets, atteds, file);
+
+  /**
+   * The analysis sections are optional, a section whose content does not fit the
+   * AAF is dropped
+   */
+  AnalysisCache &analysis = ar->analysis;
+  for (std::uint32_t i = 0; i < header.section_cnt; i++) {
+    const Section &section = table[i];
+    const char *data = base + section.offset;
+    if (section.type == sections::GROUNDED && section.size % 4 == 0) {
+      const arg_t *ext = reinterpret_cast<const arg_t*>(data);
+      const std::uint64_t size = section.size / 4;
+      bool valid = size <= n;
+      for (std::uint64_t j = 0; valid && j < size; j++)
+        valid = ext[j] >= 0 && ext[j] < (arg_t)n && (j == 0 || ext[j-1] < ext[j]);
+      if (!valid)
+        continue;
+      analysis.has_grounded = true;
+      analysis.grounded.assign(ext, ext + size);
+    } else if (section.type == sections::SCCS && section.size == 4 * n) {
+      const int *sccs = reinterpret_cast<const int*>(data);
+      if (std::all_of(sccs, sccs + n, [n](int scc) {return scc >= 0 && scc < (int)n;}))
+        analysis.sccs.assign(sccs, sccs + n);
+    } else if (section.type == sections::ORDER && section.size >= 8) {
+      const std::uint64_t len = *reinterpret_cast<const std::uint64_t*>(data);
+      if (len > section.size - 8 || padded(len) > section.size - 8
+          || section.size - 8 - padded(len) != sizeof(OrderEntry) * n)
+        continue;
+      const OrderEntry *entries = reinterpret_cast<const OrderEntry*>(data + 8 + padded(len));
+      // an order has to be a permutation of the arguments
+      std::vector<bool> seen (n, false);
+      bool valid = true;
+      for (std::uint64_t j = 0; valid && j < n; j++) {
+        const std::int32_t arg = entries[j].arg;
+        valid = arg >= 0 && arg < (std::int32_t)n && !seen[arg];
+        if (valid)
+          seen[arg] = true;
+      }
+      if (!valid)
+        continue;
+      auto &order = analysis.orders[std::string(data + 8, len)];
+      order.clear();
+      order.reserve(n);
+      for (std::uint64_t j = 0; j < n; j++)
+        order.push_back(std::pair<int,double>(entries[j].arg, entries[j].val));
+    }
+  }
+  return ar;
+}
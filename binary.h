@@ -0,0 +1,34 @@
+#include "AAF.h"
+
+#pragma once
+
+/**
+ * The binary format stores an AAF such that it can be memory mapped and solved
+ * without any parsing. A file consists of a header, a table of sections and the
+ * sections themselves, all numbers are stored in native byte order and every
+ * section starts at a multiple of 8 bytes:
+ *  - labels: n+1 offsets into the following label bytes
+ *  - attackers, attacked: the attack relation in compressed sparse row format,
+ *    n+1 offsets followed by the sorted neighbour ids, the attack relation uses
+ *    them in place
+ *  - grounded, sccs, orders: optional results of analyses (see AnalysisCache)
+ */
+
+/**
+ * Writes an AAF along with the analyses cached by its attack relation
+ * @param  path the destination file
+ * @param  aaf  the AAF
+ * @param  ar   the attack relation of the AAF
+ * @return      false iff the file could not be written
+ */
+bool writeBinary(const std::string &path, const AAF &aaf, const AttackRelation &ar) ;
+
+/**
+ * Maps a binary file, labels are not copied but refer to the mapping, which is
+ * kept alive by the AAF
+ * @param  aaf  the AAF to be populated
+ * @param  path the source file
+ * @return      the attack relation including all cached analyses or nullptr if
+ *              the file could not be mapped or is not valid
+ */
+AttackRelation * loadBinary(AAF &aaf, const std::string &path) ;
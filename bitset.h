@@ -0,0 +1,40 @@
+#include <cstdint>
+
+#pragma once
+
+/**
+ * Word-parallel operations on sets of arguments which are stored as bitsets. A set
+ * over n arguments consists of bits::words(n) words, argument i is represented by
+ * bit i%64 of word i/64 and unused bits of the last word are always 0. The loops
+ * are simple enough to be vectorized by the compiler.
+ */
+namespace bits {
+  typedef std::uint64_t word_t;
+
+  /**
+   * @return the number of words needed for a set over n arguments
+   */
+  inline int words(int n) {return (n + 63) / 64;}
+
+  inline bool test(const word_t *set, int i) {return set[i >> 6] >> (i & 63) & 1;}
+  inline void insert(word_t *set, int i) {set[i >> 6] |= (word_t)1 << (i & 63);}
+  inline void erase(word_t *set, int i) {set[i >> 6] &= ~((word_t)1 << (i & 63));}
+
+  /**
+   * Adds all elements of b to a
+   */
+  inline void unite(word_t *a, const word_t *b, int cnt) {
+    for (int i = 0; i < cnt; i++)
+      a[i] |= b[i];
+  }
+
+  /**
+   * @return true iff a is a subset of b
+   */
+  inline bool subset(const word_t *a, const word_t *b, int cnt) {
+    word_t rest = 0;
+    for (int i = 0; i < cnt; i++)
+      rest |= a[i] & ~b[i];
+    return !rest;
+  }
+}
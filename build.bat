@@ -1 +1 @@
-g++ --std=c++11 -O3 -I %localappdata%/Lxss/rootfs/usr/include/eigen3 -o heureka.exe *.cpp
+g++ --std=c++11 -O3 -pthread -I %localappdata%/Lxss/rootfs/usr/include/eigen3 -o heureka.exe *.cpp
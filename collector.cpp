@@ -1,14 +1,26 @@
 #include "collector.h"
+#include "solver.h"
+
+#include <algorithm>
+
+void Solver::report_exts (const AttackRelation &ar, ExtensionCollector &results) {
+  for (auto &ext : enum_exts(ar)) {
+    labelling_t labels (ar.arg_cnt, labels::OUT);
+    for (int arg : ext)
+      labels[arg] = labels::IN;
+    results.report_ext_labelling(labels, ext);
+    if (results.is_stopped())
+      break;
+  }
+}
 
 void ExtensionEnumerator::report_ext_labelling (const labelling_t &labels) {
-  std::vector<int> ext;
+  ext.clear();
   for (int i = 0; i<labels.size(); i++) {
     if(labels[i] == labels::IN)
       ext.push_back(i);
   }
-  exts.push_back(ext);
-  if (max_cnt && exts.size() >= max_cnt)
-    stop();
+  report_ext_labelling(labels, ext);
 }
 
 void ExtensionEnumerator::report_ext_labelling (const labelling_t &labels, const std::vector<int> &ext) {
@@ -17,6 +29,29 @@ void ExtensionEnumerator::report_ext_labelling (const labelling_t &labels, const
     stop();
 }
 
+void ExtensionPrinter::report_ext_labelling (const labelling_t &labels) {
+  ext.clear();
+  for (int i = 0; i<labels.size(); i++) {
+    if(labels[i] == labels::IN)
+      ext.push_back(i);
+  }
+  report_ext_labelling(labels, ext);
+}
+
+void ExtensionPrinter::report_ext_labelling (const labelling_t &labels, const std::vector<int> &ext) {
+  if (first)
+    first = false;
+  else
+    out << ',';
+  if (std::is_sorted(ext.begin(), ext.end())) {
+    print(ext);
+  } else {
+    sorted.assign(ext.begin(), ext.end());
+    std::sort(sorted.begin(), sorted.end());
+    print(sorted);
+  }
+}
+
 void ArgumentJustifier::report_ext_labelling (const labelling_t &labels) {
   if (!is_stopped()) {
     if (sceptical) {
@@ -32,3 +67,21 @@ void ArgumentJustifier::report_ext_labelling (const labelling_t &labels) {
     }
   }
 }
+
+void SharedCollector::report_ext_labelling (const labelling_t &labels) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (is_stopped())
+    return;
+  collector.report_ext_labelling(labels);
+  if (collector.is_stopped())
+    stop();
+}
+
+void SharedCollector::report_ext_labelling (const labelling_t &labels, const std::vector<int> &ext) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (is_stopped())
+    return;
+  collector.report_ext_labelling(labels, ext);
+  if (collector.is_stopped())
+    stop();
+}
@@ -1,4 +1,11 @@
 #include <vector>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <ostream>
+
+#include "extension_store.h"
 
 namespace {
   /**
@@ -27,7 +34,19 @@ namespace {
  * A container which controls an algorithm and collects its results
  */
 class ExtensionCollector {
-  bool stopped = false;
+  /**
+   * may be set by another thread than the one which checks it
+   */
+  std::atomic<bool> stopped {false};
+  /**
+   * a flag by which another thread may cancel the algorithm, or null
+   */
+  const std::atomic<bool> *cancelled = nullptr;
+protected:
+  /**
+   * Lets the collector be cancelled by the same flag as another one
+   */
+  inline void follow(const ExtensionCollector &collector) {cancelled = collector.cancelled;}
 public:
   /**
    * Indicate that the collector is satisfied
@@ -35,18 +54,23 @@ public:
   inline void stop() {stopped=true;}
   /**
    * Indicate whether the container is satisfied
-   * @return true iff satisfied
+   * @return true iff satisfied or cancelled
    */
-  inline bool is_stopped() const {return stopped;};
+  inline bool is_stopped() const {return stopped || cancelled && *cancelled;};
+  /**
+   * @param flag a flag which cancels the algorithm once it is set, or null
+   */
+  inline void cancel_with(const std::atomic<bool> *flag) {cancelled = flag;}
   /**
    * Process an extension
    * @param labels an extension labelling
    */
   virtual void report_ext_labelling (const labelling_t &labels) = 0;
   /**
-   * Process an extension
+   * Process an extension, algorithms which keep track of their IN arguments call
+   * this instead of letting the collector scan the labelling
    * @param labels an extension labelling L
-   * @param ext    the extension IN(L)
+   * @param ext    the extension IN(L) in any order
    */
   virtual void report_ext_labelling (const labelling_t &labels, const std::vector<int> &ext) {
     report_ext_labelling(labels);
@@ -56,15 +80,55 @@ public:
 /**
  * A collector which enumerates all or a limited number of extension
  */
-class ExtensionEnumerator : public ExtensionCollector {
+class ExtensionEnumerator final : public ExtensionCollector {
   const int max_cnt;
+  /**
+   * scratch space for the extension of a labelling
+   */
+  std::vector<int> ext;
 public:
-  std::vector<std::vector<int>> exts;
+  /**
+   * the extensions
+   */
+  ExtensionStore exts;
   /**
    * Constructs a new collector
+   * @param arg_cnt the number of arguments of the AAF
    * @param max_cnt the number of extensions needed
    */
-  ExtensionEnumerator (int max_cnt = 0) : max_cnt(max_cnt) {}
+  ExtensionEnumerator (int arg_cnt, int max_cnt = 0) : max_cnt(max_cnt), exts(arg_cnt) {}
+  void report_ext_labelling (const labelling_t &labels) override ;
+  void report_ext_labelling (const labelling_t &labels, const std::vector<int> &ext) override ;
+};
+
+/**
+ * A collector which counts extensions without storing them
+ */
+class ExtensionCounter final : public ExtensionCollector {
+public:
+  std::uint64_t count = 0;
+  inline void report_ext_labelling (const labelling_t &labels) override {count++;}
+  inline void report_ext_labelling (const labelling_t &labels, const std::vector<int> &ext) override {count++;}
+};
+
+/**
+ * A collector which writes every extension to a stream as soon as it is reported
+ * instead of storing it, the extensions are separated by commas and passed to the
+ * printer sorted by id. The stream is not flushed in between.
+ */
+class ExtensionPrinter final : public ExtensionCollector {
+  std::ostream &out;
+  const std::function<void (const std::vector<int> &)> print;
+  std::vector<int> ext, sorted;
+  bool first = true;
+public:
+  /**
+   * Creates a new collector
+   * @param out   the stream
+   * @param print writes an extension to the stream
+   */
+  ExtensionPrinter (std::ostream &out, const std::function<void (const std::vector<int> &)> &print)
+    : out(out), print(print) {}
   void report_ext_labelling (const labelling_t &labels) override ;
   void report_ext_labelling (const labelling_t &labels, const std::vector<int> &ext) override ;
 };
@@ -72,7 +136,7 @@ public:
 /**
  * A collector which determines whether an argument is justified
  */
-class ArgumentJustifier : public ExtensionCollector {
+class ArgumentJustifier final : public ExtensionCollector {
   const bool sceptical;
   const int arg;
   bool justified;
@@ -89,5 +153,23 @@ public:
     * @return true iff the argument is justified
   */
   inline bool is_justified() const {return justified;}
+  using ExtensionCollector::report_ext_labelling;
   void report_ext_labelling (const labelling_t &labels) override ;
 };
+
+/**
+ * A collector which lets several threads report extensions to another collector,
+ * reports are serialized and the collector is stopped as soon as the other one is
+ */
+class SharedCollector final : public ExtensionCollector {
+  ExtensionCollector &collector;
+  std::mutex mutex;
+public:
+  /**
+   * Creates a new collector
+   * @param collector the collector to which extensions are passed on
+   */
+  SharedCollector (ExtensionCollector &collector) : collector(collector) {follow(collector);}
+  void report_ext_labelling (const labelling_t &labels) override ;
+  void report_ext_labelling (const labelling_t &labels, const std::vector<int> &ext) override ;
+};
@@ -0,0 +1,131 @@
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <algorithm>
+
+#pragma once
+
+/**
+ * A list of extensions which are stored one after another in a single arena, an
+ * offsets array marks where every extension starts. Every extension is encoded
+ * either as its sorted ids or as a bitset over all arguments, whichever takes less
+ * words. An extension with as many words as the bitset is a bitset, a shorter one
+ * consists of ids. Extensions are decoded into sorted ids when they are accessed.
+ */
+class ExtensionStore {
+  int arg_cnt;
+  /**
+   * the number of words of a bitset
+   */
+  std::size_t words;
+  std::vector<std::uint32_t> arena;
+  std::vector<std::size_t> offsets {0};
+  /**
+   * scratch space to sort the ids of an extension
+   */
+  std::vector<int> sorted;
+public:
+  /**
+   * Iterates over the extensions, every extension is decoded into a vector which
+   * is valid until the iterator is dereferenced or advanced again
+   */
+  class const_iterator {
+    const ExtensionStore *store;
+    std::size_t pos;
+    mutable std::vector<int> ext;
+  public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef std::vector<int> value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const std::vector<int> *pointer;
+    typedef const std::vector<int> &reference;
+
+    const_iterator(const ExtensionStore *store, std::size_t pos) : store(store), pos(pos) {}
+    inline reference operator*() const {store->decode(pos, ext); return ext;}
+    inline pointer operator->() const {return &**this;}
+    inline const_iterator &operator++() {pos++; return *this;}
+    inline const_iterator operator++(int) {const_iterator old = *this; pos++; return old;}
+    inline bool operator==(const const_iterator &other) const {return pos == other.pos;}
+    inline bool operator!=(const const_iterator &other) const {return pos != other.pos;}
+  };
+
+  /**
+   * @param arg_cnt the number of arguments, every stored id has to be below it
+   */
+  explicit ExtensionStore(int arg_cnt) : arg_cnt(arg_cnt), words((arg_cnt + 31) / 32) {}
+
+  /**
+   * Appends an extension
+   * @param ext the ids of the extension in any order
+   */
+  void push_back(const std::vector<int> &ext) {
+    if (ext.size() >= words) {
+      const std::size_t start = arena.size();
+      arena.resize(start + words, 0);
+      for (int arg : ext)
+        arena[start + arg / 32] |= std::uint32_t(1) << arg % 32;
+    } else if (std::is_sorted(ext.begin(), ext.end())) {
+      arena.insert(arena.end(), ext.begin(), ext.end());
+    } else {
+      sorted.assign(ext.begin(), ext.end());
+      std::sort(sorted.begin(), sorted.end());
+      arena.insert(arena.end(), sorted.begin(), sorted.end());
+    }
+    offsets.push_back(arena.size());
+  }
+
+  /**
+   * Visits the ids of an extension in ascending order without decoding it
+   * @param i     the position of the extension
+   * @param visit called with every id
+   */
+  template <class Visitor>
+  inline void for_each(std::size_t i, Visitor visit) const {
+    const std::uint32_t *first = arena.data() + offsets[i], *last = arena.data() + offsets[i + 1];
+    if (std::size_t(last - first) < words) {
+      for (; first != last; first++)
+        visit(int(*first));
+      return;
+    }
+    for (std::size_t w = 0; w < words; w++)
+      for (std::uint32_t word = first[w]; word; word &= word - 1)
+        visit(int(w * 32 + __builtin_ctz(word)));
+  }
+
+  /**
+   * Decodes an extension
+   * @param i   the position of the extension
+   * @param ext populated with the sorted ids of the extension
+   */
+  inline void decode(std::size_t i, std::vector<int> &ext) const {
+    ext.clear();
+    for_each(i, [&](int arg) {ext.push_back(arg);});
+  }
+
+  /**
+   * @param  i the position of an extension
+   * @return   the sorted ids of the extension
+   */
+  inline std::vector<int> operator[](std::size_t i) const {
+    std::vector<int> ext;
+    decode(i, ext);
+    return ext;
+  }
+
+  inline std::vector<int> front() const {return (*this)[0];}
+  inline std::vector<int> back() const {return (*this)[size() - 1];}
+  inline std::size_t size() const {return offsets.size() - 1;}
+  inline bool empty() const {return offsets.size() == 1;}
+  inline int get_arg_cnt() const {return arg_cnt;}
+  inline const_iterator begin() const {return const_iterator(this, 0);}
+  inline const_iterator end() const {return const_iterator(this, size());}
+
+  /**
+   * Decodes all extensions into the list of extensions which solvers returned before
+   * the store was introduced
+   */
+  inline operator std::vector<std::vector<int>>() const {
+    return std::vector<std::vector<int>>(begin(), end());
+  }
+};
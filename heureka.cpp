@@ -1,10 +1,16 @@
 #include <iostream>
 #include <chrono>
 #include <regex>
+#include <algorithm>
+#include <cstdlib>
 #include <fstream>
 
 #include "parser.h"
+#include "binary.h"
+#include "kernel.h"
+#include "renumbering.h"
 #include "solver.h"
+#include "collector.h"
 #include "test.h"
 
 
@@ -27,22 +33,36 @@ namespace {
       start = now;
     }
   };
+
+  /**
+   * The heuristics which are used if none is specified, for stable and for all other
+   * semantics respectively
+   */
+  const std::string default_heuristic_st = "+ * scc 1000 + / + outdeg 1 + indeg 1 /  +  outpath inpath 1000",
+    default_heuristic = "+ * scc 1000 * -1 * outpath inpath";
 }
 
 
 int main(int argcnt, char ** args) {
+  /**
+   * output is only written through the streams, which buffer it then
+   */
+  std::ios::sync_with_stdio(false);
   if (argcnt == 1) {
     std::cout << "heureka 0.2" << std::endl
       << "Nils Geilen <geilenn@uni-koblenz.de>" << std::endl
       << "Matthias Thimm <thimm@uni-koblenz.de>" << std::endl;
   } else if (std::string {args[1]} == "--formats") {
-    std::cout << "[apx,tgf]" << std::endl;
+    std::cout << "[apx,tgf,bin]" << std::endl;
   } else if (std::string {args[1]} == "--problems") {
-    std::cout << "[EE-ST,EE-CO,EE-PR,SE-ST,SE-CO,SE-PR,SE-GR,DC-ST,DC-CO,DC-PR,DC-GR,DS-ST,DS-CO,DS-PR]" << std::endl;
+    std::cout << "[EE-ST,EE-CO,EE-PR,CE-ST,CE-CO,CE-PR,SE-ST,SE-CO,SE-PR,SE-GR,DC-ST,DC-CO,DC-PR,DC-GR,DS-ST,DS-CO,DS-PR]" << std::endl;
   } else if (std::string {args[1]} == "--test") {
-    test();
+    return test() ? 1 : 0;
   } else {
-    std::string task, semantics, path, format, item, param_heuristic, param_debug_options;
+    std::string task, semantics, path, format, item, param_heuristic, param_debug_options, output,
+      param_renumbering, param_backend = "auto",
+      param_kernel = "on", param_scc = "off", param_portfolio;
+    int threads = 1;
     for (int i = 1; i < argcnt - 1; i+=2) {
       std::string param_specifier {args[i]};
       if (param_specifier == "-p") {
@@ -65,6 +85,20 @@ int main(int argcnt, char ** args) {
         param_heuristic = args[i+1];
       } else if (param_specifier == "-d") {
         param_debug_options = args[i+1];
+      } else if (param_specifier == "-r") {
+        param_renumbering = args[i+1];
+      } else if (param_specifier == "-k") {
+        param_kernel = args[i+1];
+      } else if (param_specifier == "-P") {
+        param_portfolio = args[i+1];
+      } else if (param_specifier == "-s") {
+        param_scc = args[i+1];
+      } else if (param_specifier == "-b") {
+        param_backend = args[i+1];
+      } else if (param_specifier == "-o") {
+        output = args[i+1];
+      } else if (param_specifier == "-j") {
+        threads = std::max(1, std::atoi(args[i+1]));
       }
     }
 
@@ -78,12 +112,14 @@ int main(int argcnt, char ** args) {
         format = "apx";
       else if (ending == ".tgf")
         format = "tgf";
+      else if (ending == ".bin")
+        format = "bin";
     }
 
     /**
      * abort if an obligatory param is missing
      */
-    if (!(task.size() && semantics.size() && path.size() && format.size())) {
+    if (!((output.size() || task.size() && semantics.size()) && path.size() && format.size())) {
       std::cerr << "Fail: Obligatory params missing" << std::endl;
       return 0;
     }
@@ -91,20 +127,21 @@ int main(int argcnt, char ** args) {
     Clock clock;
 
     AAF aaf ;
+    AttackRelation *ar = nullptr;
 
-    std::ifstream file;
-    file.open (path);
-    if (!file.is_open()) {
-      std::cerr << "Fail: Could not open file \"" << path << '"' << std::endl;
-      return 0;
-    }
-
-    if (format == "apx") {
-      parseAPX(aaf, file);
+    if (format == "bin") {
+      ar = loadBinary(aaf, path);
+      if (!ar) {
+        std::cerr << "Fail: Could not open binary file \"" << path << '"' << std::endl;
+        return 0;
+      }
     } else {
-      parseTGF(aaf, file);
+      if (!loadAAF(aaf, path, format, threads)) {
+        std::cerr << "Fail: Could not open file \"" << path << '"' << std::endl;
+        return 0;
+      }
+      ar = new AttackRelation(aaf);
     }
-    file.close();
 
     if (param_debug_options.size()) {
       std::cerr << format << " ; ";
@@ -114,33 +151,86 @@ int main(int argcnt, char ** args) {
       std::cerr <<"|R| = "<<aaf.atts.size()<<std::endl;
     }
 
+  //  clock.stop("parsing");
 
-    AttackRelation ar (aaf);
+    /**
+     * convert the AAF into the binary format along with precomputed analyses
+     */
+    if (output.size()) {
+      ar->analysis.grounded = GroundedSolver(threads).find_ext(*ar);
+      ar->analysis.has_grounded = true;
+      ar->analysis.sccs = compute_sccs(*ar);
+      std::vector<std::string> expressions {default_heuristic_st, default_heuristic};
+      if (param_heuristic.size())
+        expressions = {param_heuristic};
+      for (auto &expression : expressions) {
+        std::stringstream source(expression);
+        Heuristic *heuristic = parseHeuristic(aaf, *ar, source);
+        if (heuristic && !heuristic->is_dynamic()) {
+          heuristic->sort();
+          ar->analysis.orders[expression] = heuristic->get_order();
+        }
+        delete heuristic;
+      }
+      if (!writeBinary(output, aaf, *ar))
+        std::cerr << "Fail: Could not write file \"" << output << '"' << std::endl;
+      delete ar;
+      return 0;
+    }
 
-  //  clock.stop("parsing");
+    /**
+     * continue on the kernel of the AAF, from which arguments whose status is already
+     * known are removed
+     */
+    AAF residual;
+    std::vector<kernel::status_t> status;
+    std::vector<arg_t> grounded;
+    bool reduced = false, no_stable = false;
+    if (param_kernel != "on" && param_kernel != "off") {
+      std::cerr << "Fail: Unknown kernel option " << param_kernel << std::endl;
+      return 0;
+    }
+    if (param_kernel == "on" && (semantics == "ST" || semantics == "PR"
+        || semantics == "CO" && task != "DS" && task != "SE")) {
+      AttackRelation *kernel = kernelize(aaf, *ar, residual, status);
+      for (arg_t i = 0; i < ar->arg_cnt; i++) {
+        if (status[i] == kernel::IN)
+          grounded.push_back(i);
+        else if (status[i] == kernel::UNDEC && semantics == "ST")
+          no_stable = true;
+      }
+      reduced = residual.args.size() < aaf.args.size();
+      if (reduced) {
+        delete ar;
+        ar = kernel;
+      } else {
+        /**
+         * keep the cached analyses of the AAF
+         */
+        delete kernel;
+        status.clear();
+      }
+      if (param_debug_options.size())
+        std::cerr << "kernel |A| = " << residual.args.size() << " ; |R| = " << residual.atts.size() << std::endl;
+    }
+    AAF &work = reduced ? residual : aaf;
 
     Solver *solver = nullptr;
     Heuristic *heuristic = nullptr;
+    const std::string &expression = param_heuristic.size() ? param_heuristic
+      : semantics == "ST" ? default_heuristic_st : default_heuristic;
 
     if (semantics == "GR" || semantics == "CO" && (task == "DS" || task == "SE")) {
       /**
        * no heuristics necessary
        */
     } else {
-      if (param_heuristic.size()) {
-        std::stringstream source(param_heuristic);
-        heuristic = parseHeuristic(aaf, ar, source);
+      auto cached = ar->analysis.orders.find(expression);
+      if (cached != ar->analysis.orders.end()) {
+        heuristic = new PrecomputedHeuristic(cached->second);
       } else {
-        /**
-         * standard heurstic (0.25*A)^5
-         */
-        if (semantics == "ST") {
-          std::stringstream strstr ("+ * scc 1000 + / + outdeg 1 + indeg 1 /  +  outpath inpath 1000");
-          heuristic = parseHeuristic (aaf, ar, strstr);
-        } else {
-          std::stringstream strstr ("+ * scc 1000 * -1 * outpath inpath");
-          heuristic = parseHeuristic (aaf, ar, strstr);
-        }
+        std::stringstream source(expression);
+        heuristic = parseHeuristic(work, *ar, source);
       }
       if (! heuristic) {
         std::cerr << "Fail: heuristic could not be parsed"<< std::endl;
@@ -150,41 +240,171 @@ int main(int argcnt, char ** args) {
         std::cerr << *heuristic << std::endl;
         std::cerr << '[' << heuristic->get_min_val() <<", "<<heuristic->get_max_val()<<']'<<std::endl;
       }
-      heuristic->sort();
+      if (cached == ar->analysis.orders.end())
+        heuristic->sort();
+    }
+
+    /**
+     * renumber the arguments to improve memory locality. A static heuristic is
+     * computed beforehand and translated, such that the search still visits the
+     * arguments in the same order. Renumbering according to the heuristic is
+     * skipped if none is needed.
+     */
+    if (param_renumbering.size() && (heuristic || param_renumbering != "heuristic")) {
+      std::vector<arg_t> order;
+      if (param_renumbering != "heuristic") {
+        order = locality_order(*ar, param_renumbering);
+        if (order.size() != ar->arg_cnt) {
+          std::cerr << "Fail: Unknown renumbering " << param_renumbering << std::endl;
+          return 0;
+        }
+      } else if (!heuristic->is_dynamic()) {
+        for (auto &p : heuristic->get_order())
+          order.push_back(p.first);
+      } else {
+        std::cerr << "Fail: cannot renumber according to a dynamic heuristic" << std::endl;
+        return 0;
+      }
+      std::vector<arg_t> new_id (order.size());
+      for (arg_t i = 0; i < order.size(); i++)
+        new_id[order[i]] = i;
+      std::vector<std::pair<int,double>> translated;
+      if (heuristic && !heuristic->is_dynamic())
+        for (auto &p : heuristic->get_order())
+          translated.push_back(std::pair<int,double>(new_id[p.first], p.second));
+      const bool dynamic = heuristic && heuristic->is_dynamic(),
+        translate = heuristic && !dynamic;
+      delete heuristic;
+      heuristic = nullptr;
+
+      AttackRelation *renumbered = renumber(work, *ar, order);
+      delete ar;
+      ar = renumbered;
+
+      if (dynamic) {
+        std::stringstream source(expression);
+        heuristic = parseHeuristic(work, *ar, source);
+        heuristic->sort();
+      } else if (translate) {
+        heuristic = new PrecomputedHeuristic(translated);
+      }
+    }
+
+    /**
+     * dense AAFs are additionally stored as bitsets
+     */
+    if (param_backend == "dense" || param_backend == "auto" && ar->is_dense()) {
+      ar->build_bitsets();
+    } else if (param_backend != "sparse" && param_backend != "auto") {
+      std::cerr << "Fail: Unknown backend " << param_backend << std::endl;
+      return 0;
+    }
+
+    if (param_scc != "on" && param_scc != "off") {
+      std::cerr << "Fail: Unknown SCC option " << param_scc << std::endl;
+      return 0;
+    }
+    /**
+     * a portfolio of heuristics is read from a file with one expression per line,
+     * empty lines and lines starting with # are skipped
+     */
+    std::vector<Heuristic*> portfolio;
+    if (param_portfolio.size() && heuristic) {
+      std::ifstream file(param_portfolio);
+      if (!file) {
+        std::cerr << "Fail: Could not open portfolio file \"" << param_portfolio << '"' << std::endl;
+        return 0;
+      }
+      std::string line;
+      while (std::getline(file, line)) {
+        if (line.size() && line.back() == '\r')
+          line.pop_back();
+        if (line.find_first_not_of(" \t") == std::string::npos || line[0] == '#')
+          continue;
+        std::stringstream source(line);
+        Heuristic *member = parseHeuristic(work, *ar, source);
+        if (!member) {
+          std::cerr << "Fail: heuristic could not be parsed: " << line << std::endl;
+          return 0;
+        }
+        member->sort();
+        portfolio.push_back(member);
+      }
+      if (portfolio.empty()) {
+        std::cerr << "Fail: portfolio file \"" << param_portfolio << "\" contains no heuristic" << std::endl;
+        return 0;
+      }
     }
 
+    const bool by_sccs = param_scc == "on" && heuristic;
+    for (Heuristic *member : portfolio.size() ? portfolio : std::vector<Heuristic*> {heuristic})
+      if (by_sccs && member->is_dynamic()) {
+        std::cerr << "Fail: cannot solve SCCs with a dynamic heuristic" << std::endl;
+        return 0;
+      }
+
+    auto create_solver = [&](Heuristic &heuristic, int threads) -> Solver * {
+      if (by_sccs)
+        return new SCCSolver {semantics == "ST" ? SCCSolver::STABLE
+          : semantics == "CO" ? SCCSolver::COMPLETE : SCCSolver::PREFERRED, heuristic, threads};
+      if (semantics == "ST")
+        return new StableSolver {heuristic, threads};
+      if (semantics == "CO")
+        return new CompleteSolver {heuristic};
+      return new PreferredSolver {heuristic};
+    };
+
     if (semantics == "GR" || semantics == "CO" && (task == "DS" || task == "SE")){
-      solver = new GroundedSolver {};
-    } else if (semantics == "ST") {
-      solver = new StableSolver {*heuristic};
-    } else if (semantics == "CO") {
-      solver = new CompleteSolver {*heuristic};
-    } else if (semantics == "PR") {
-      solver = new PreferredSolver {*heuristic};
-    } else {
+      solver = new GroundedSolver {threads};
+    } else if (semantics != "ST" && semantics != "CO" && semantics != "PR") {
         std::cerr << "Fail: Semantics " << semantics << " not supported" << std::endl;
         return 0;
+    } else if (portfolio.size()) {
+      /**
+       * every heuristic of the portfolio is raced on its own thread
+       */
+      std::vector<Solver*> solvers;
+      for (Heuristic *member : portfolio)
+        solvers.push_back(create_solver(*member, 1));
+      solver = new PortfolioSolver {solvers};
+    } else {
+      solver = create_solver(*heuristic, threads);
     }
 
   //  clock.stop("heuristic");
 
-    if (task == "EE") {
-      std::vector<std::vector<int>> results = solver -> enum_exts(ar);
+    auto print = [&](const std::vector<int> &ext) {
+      if (reduced)
+        aaf.print(restore(residual, grounded, ext), std::cout);
+      else
+        aaf.print(ext, std::cout);
+    };
 
+    if (task == "EE") {
+      /**
+       * every extension is printed as soon as it is found
+       */
+      ExtensionPrinter results {std::cout, print};
       std::cout<<'[';
-      bool first = true;
-      for (auto &ext: results){
-        if (first)
-          first = false;
-        else
-          std::cout << ',';
-        aaf.print(ext, std::cout);
-      }
+      if (!no_stable)
+        solver -> report_exts(*ar, results);
       std::cout<<']'<<std::endl;
+    } else if (task == "CE") {
+      if (no_stable)
+        std::cout << 0;
+      else if (heuristic)
+        std::cout << count_by_components(*ar, *heuristic, [&](Heuristic &heuristic) {
+          return create_solver(heuristic, threads);
+        });
+      else
+        std::cout << solver -> count_exts(*ar);
+      std::cout << std::endl;
     } else if (task == "SE") {
-      auto exts = solver -> enum_exts(ar, 1);
+      ExtensionStore exts (ar->arg_cnt);
+      if (!no_stable)
+        exts = solver -> enum_exts(*ar, 1);
       if (exts.size()) {
-        aaf.print(exts[0], std::cout);
+        print(exts[0]);
       } else
         std::cout << "NO";
       std::cout << std::endl;
@@ -193,20 +413,29 @@ int main(int argcnt, char ** args) {
         std::cerr << "Fail: Params missing" << std::endl;
         return 0;
       }
-      arg_t arg;
-      bool found = false;
-      for (auto a : aaf.args) {
-        if (a.label == item) {
-          arg = a.id;
-          found = true;
-          break;
-        }
-      }
-      if (! found) {
+      arg_t arg = aaf.find(item);
+      if (arg < 0) {
         std::cerr << "Fail: Argument \""<<item<<"\" not found" << std::endl;
         return 0;
       }
-      bool justified =  solver -> justify (ar, arg, task == "DS");
+      const bool sceptical = task == "DS";
+      bool justified;
+      if (no_stable) {
+        justified = sceptical;
+      } else if (status.size() && status[arg] != kernel::UNKNOWN) {
+        const bool accepted = status[arg] == kernel::IN;
+        /**
+         * an argument which is IN in every complete labelling is credulously accepted
+         * and one which is not is sceptically rejected only if there is a stable
+         * extension at all
+         */
+        if (semantics == "ST" && accepted != sceptical)
+          justified = accepted == !solver -> enum_exts(*ar, 1).empty();
+        else
+          justified = accepted;
+      } else {
+        justified = solver -> justify (*ar, reduced ? residual.find(item) : arg, sceptical);
+      }
       std::cout << (justified ? "YES" : "NO") << std::endl;
     } else {
         std::cerr << "Fail: Unknown task " << task << std::endl;
@@ -218,6 +447,9 @@ int main(int argcnt, char ** args) {
 
     delete solver;
     delete heuristic;
+    for (Heuristic *member : portfolio)
+      delete member;
+    delete ar;
 
   }
   return 0;
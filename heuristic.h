@@ -64,6 +64,10 @@ public:
   rational_t get_max_val() const;
   inline bool is_dynamic() {return _dynamic;}
   inline bool is_const() {return _const;}
+  /**
+   * @return every argument paired with its heuristic score
+   */
+  inline const std::vector<std::pair<int,rational_t>> &get_order() const {return order;}
   friend std::ostream& operator <<(std::ostream& stream, const Heuristic& heuristic) ;
 };
 
@@ -87,6 +91,51 @@ public:
   auto get(int from, const HeuristicAlgorithm &algo) -> int override {return from;}
 };
 
+/**
+ * A static heuristic whose order was computed beforehand, e.g. loaded from a binary file
+ * @param order every argument paired with its heuristic score
+ */
+class PrecomputedHeuristic: public Heuristic {
+public:
+  PrecomputedHeuristic(const std::vector<std::pair<int,rational_t>> &order) : Heuristic() {this->order = order;}
+};
+
+/**
+ * Policies by which backtracking algorithms read a heuristic. The algorithms are
+ * templated on them, so the order of a static heuristic is read inline and only a
+ * dynamic heuristic is called virtually.
+ */
+
+/**
+ * Reads the order of a static heuristic
+ * @param heuristic the heuristic, which must not be dynamic or constant
+ */
+class StaticOrder {
+  const std::vector<std::pair<int,rational_t>> &order;
+public:
+  explicit StaticOrder(const Heuristic &heuristic) : order(heuristic.get_order()) {}
+  inline int get(int from, const HeuristicAlgorithm &algo) const {return order[from].first;}
+};
+
+/**
+ * Reads the order of a ConstHeuristic, which takes the arguments by id
+ */
+class IdentityOrder {
+public:
+  inline int get(int from, const HeuristicAlgorithm &algo) const {return from;}
+};
+
+/**
+ * Asks a heuristic, which may be dynamic, for every argument
+ * @param heuristic the heuristic
+ */
+class DynamicOrder {
+  Heuristic &heuristic;
+public:
+  explicit DynamicOrder(Heuristic &heuristic) : heuristic(heuristic) {}
+  inline int get(int from, const HeuristicAlgorithm &algo) {return heuristic.get(from, algo);}
+};
+
 /**
  * A heuristic which assigns each argument a score based on in- and outgoing paths
  * @param ar        the aaf as a attack relation
@@ -191,6 +240,13 @@ public:
   int get(int from, const HeuristicAlgorithm &algo) override ;
 };
 
+/**
+ * Computes the strongly connected components of an AAF with Tarjan's algorithm
+ * @param  ar the aaf as a attack relation
+ * @return    the id of every argument's SCC
+ */
+std::vector<int> compute_sccs(const AttackRelation &ar);
+
 /**
  * A heuirstic based on SCCs
  * @param ar the aaf as a attack relation
@@ -14,7 +14,7 @@ public:
     std::vector<Eigen::Triplet<entry_t>> tripletList(aaf.atts.size());
     for(auto&att:aaf.atts)
     {
-      tripletList.push_back(Eigen::Triplet<entry_t>(att.active.id, att.passive.id,-1));
+      tripletList.push_back(Eigen::Triplet<entry_t>(att.active, att.passive,-1));
     }
     a.setFromTriplets(tripletList.begin(), tripletList.end());
 
@@ -45,7 +45,7 @@ DenseExponentialHeuristic::DenseExponentialHeuristic (AAF &aaf, int window_size)
   const int n = aaf.args.size();
   MatrixXf a(n,n);
   for(auto&att:aaf.atts) {
-    a(att.active.id, att.passive.id) = -1;
+    a(att.active, att.passive) = -1;
   }
 
   auto pot = a, result = a;
@@ -34,35 +34,55 @@ private:
   int index = 0, component = 0;
 
 
-  void visit (node_t v) {
+  /**
+   * Visits the nodes reachable from root depth first, the recursion is unrolled into
+   * an explicit stack of nodes and positions in their neighbourhoods, because large
+   * AAFs would overflow the call stack
+   */
+  void visit (node_t root) {
+    std::vector<std::pair<node_t, int>> calls {{root, 0}};
+    open(root);
+    while (!calls.empty()) {
+      const node_t v = calls.back().first;
+      const auto &atteds = ar.attacked_set(v);
+      int &pos = calls.back().second;
+      if (pos < (int)atteds.size()) {
+        node_t w = atteds[pos++];
+        if (!visited[w]) {
+          open(w);
+          calls.push_back({w, 0});
+        } else if (on_stack[w]) {
+          lowlink[v] = std::min(lowlink[v], indices[w]);
+        }
+        continue;
+      }
+      calls.pop_back();
+      if (!calls.empty()) {
+        const node_t parent = calls.back().first;
+        lowlink[parent] = std::min(lowlink[parent], lowlink[v]);
+      }
+      if (lowlink[v] == indices[v]) {
+        while (true) {
+          node_t w = stack.top();
+          stack.pop();
+          on_stack[w] = false;
+          sccs[w] = component;
+          if (w==v)
+            break;
+        }
+        component++;
+      }
+    }
+  }
+
+  inline void open (node_t v) {
     indices[v] = index;
     lowlink[v] = index ++;
     visited[v] = true;
     on_stack[v] = true;
     stack.push(v);
-    for (node_t w : ar.attacked_set(v)) {
-      if (!visited[w])
-        {visit(w);
-        lowlink[v] = std::min(lowlink[v], lowlink[w]);}
-      else if (on_stack[w]) {
-        lowlink[v] = std::min(lowlink[v], indices[w]);
-      }
-    }
-    if (lowlink[v] == indices[v]) {
-      while (true) {
-        node_t w = stack.top();
-        stack.pop();
-        on_stack[w] = false;
-        sccs[w] = component;
-        if (w==v)
-          break;
-      }
-      component++;
-    }
   }
 
-
-
 };
 
 
@@ -146,7 +166,7 @@ struct SCC {
 
 SCCHeuristic::SCCHeuristic(const AttackRelation&ar) : Heuristic()  {
   TarjansAlgorithm t(ar) ;
-  auto  s = t.exec();
+  auto  s = ar.analysis.sccs.size() ? ar.analysis.sccs : t.exec();
 
 
   std::unordered_map<int, SCC*> sccs;
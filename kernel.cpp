@@ -0,0 +1,108 @@
+#include "kernel.h"
+#include "solver.h"
+
+#include <algorithm>
+
+AttackRelation * kernelize(const AAF &aaf, const AttackRelation &ar, AAF &residual, std::vector<kernel::status_t> &status) {
+  using namespace kernel;
+  const int n = ar.arg_cnt;
+  status.assign(n, UNKNOWN);
+  for (arg_t arg : GroundedSolver().find_ext(ar)) {
+    status[arg] = IN;
+    for (arg_t atted : ar.attacked_set(arg))
+      status[atted] = OUT;
+  }
+
+  /**
+   * Self-attackers and arguments attacked by an argument which is always undecided
+   * can never be IN (dead). Dead arguments whose attackers are dead can never be
+   * OUT either, so they are always undecided.
+   */
+  std::vector<bool> dead (n, false);
+  std::vector<int> alive_atters (n, 0);
+  std::vector<arg_t> pending;
+  for (arg_t i = 0; i < n; i++)
+    if (status[i] == UNKNOWN)
+      for (arg_t atter : ar.attacker_set(i))
+        if (status[atter] == UNKNOWN)
+          alive_atters[i]++;
+  auto kill = [&](arg_t arg) {
+    if (!dead[arg]) {
+      dead[arg] = true;
+      pending.push_back(arg);
+    }
+  };
+  auto undecide = [&](arg_t arg) {
+    if (status[arg] == UNKNOWN) {
+      status[arg] = UNDEC;
+      for (arg_t atted : ar.attacked_set(arg))
+        if (status[atted] != OUT)
+          kill(atted);
+    }
+  };
+  for (arg_t arg : ar.self_attacker_set())
+    if (status[arg] == UNKNOWN)
+      kill(arg);
+  while (!pending.empty()) {
+    const arg_t arg = pending.back();
+    pending.pop_back();
+    for (arg_t atted : ar.attacked_set(arg))
+      if (status[atted] != OUT && --alive_atters[atted] == 0 && dead[atted])
+        undecide(atted);
+    if (alive_atters[arg] == 0)
+      undecide(arg);
+  }
+
+  /**
+   * undecided arguments are kept if they reach an argument whose status is unknown,
+   * since they keep it from being accepted
+   */
+  std::vector<bool> kept (n, false);
+  for (arg_t i = 0; i < n; i++)
+    if (status[i] == UNKNOWN) {
+      kept[i] = true;
+      pending.push_back(i);
+    }
+  while (!pending.empty()) {
+    const arg_t arg = pending.back();
+    pending.pop_back();
+    for (arg_t atter : ar.attacker_set(arg))
+      if (status[atter] == UNDEC && !kept[atter]) {
+        kept[atter] = true;
+        pending.push_back(atter);
+      }
+  }
+
+  std::vector<arg_t> new_ids (n, -1);
+  for (arg_t i = 0; i < n; i++)
+    if (kept[i]) {
+      new_ids[i] = residual.args.size();
+      Argument arg = aaf.args[i];
+      arg.id = new_ids[i];
+      residual.args.push_back(arg);
+      residual.origin.push_back(i);
+    }
+  residual.source = aaf.source;
+  residual.label_store = aaf.label_store;
+  for (const Attack &att : aaf.atts)
+    if (kept[att.active] && kept[att.passive])
+      residual.atts.push_back(Attack {new_ids[att.active], new_ids[att.passive]});
+
+  AttackRelation *reduced = new AttackRelation(residual);
+  /**
+   * the grounded extension of the kernel is empty
+   */
+  reduced->analysis.has_grounded = true;
+  return reduced;
+}
+
+std::vector<arg_t> restore(const AAF &residual, const std::vector<arg_t> &grounded, const std::vector<arg_t> &ext) {
+  std::vector<arg_t> mapped;
+  mapped.reserve(ext.size());
+  for (arg_t arg : ext)
+    mapped.push_back(residual.origin[arg]);
+  std::sort(mapped.begin(), mapped.end());
+  std::vector<arg_t> restored (grounded.size() + mapped.size());
+  std::merge(grounded.begin(), grounded.end(), mapped.begin(), mapped.end(), restored.begin());
+  return restored;
+}
@@ -0,0 +1,43 @@
+#include "AAF.h"
+
+#pragma once
+
+/**
+ * The status an argument has in every complete labelling, if it is already known
+ */
+namespace kernel {
+  typedef unsigned char status_t;
+  constexpr status_t
+    UNKNOWN = 0,
+    IN = 1,
+    OUT = 2,
+    UNDEC = 3;
+}
+
+/**
+ * Reduces an AAF to its kernel for the complete, preferred and stable semantics.
+ * The grounded extension, which is contained in every extension, and the arguments
+ * attacked by it are removed. Among the remaining arguments, those which are
+ * undecided in every complete labelling are determined, they are removed if they
+ * only attack such arguments. Self-attacking arguments remain in the kernel, since
+ * they still attack others, and are labelled OUT by the algorithms.
+ * Every complete, preferred or stable extension of the AAF is the union of the
+ * grounded extension and an extension of the kernel. If there are arguments with
+ * status UNDEC, the AAF has no stable extension.
+ * @param  aaf      the AAF
+ * @param  ar       the attack relation of the AAF
+ * @param  residual populated with the arguments of the kernel, AAF::origin maps
+ *                  them to their ids in aaf
+ * @param  status   populated with the status of every argument of aaf
+ * @return          the attack relation of the kernel
+ */
+AttackRelation * kernelize(const AAF &aaf, const AttackRelation &ar, AAF &residual, std::vector<kernel::status_t> &status) ;
+
+/**
+ * Maps an extension of the kernel to the corresponding extension of the AAF
+ * @param  residual the kernel
+ * @param  grounded the sorted grounded extension of the AAF
+ * @param  ext      an extension of the kernel
+ * @return          the extension of the AAF, sorted by id
+ */
+std::vector<arg_t> restore(const AAF &residual, const std::vector<arg_t> &grounded, const std::vector<arg_t> &ext) ;
@@ -0,0 +1,34 @@
+#include "mapped_file.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string &path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return;
+  struct stat st;
+  if (fstat(fd, &st) == 0) {
+    length = st.st_size;
+    if (length == 0) {
+      // mmap refuses empty mappings
+      data = "";
+      opened = true;
+    } else {
+      void *addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr != MAP_FAILED) {
+        madvise(addr, length, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(addr);
+        mapped = opened = true;
+      }
+    }
+  }
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (mapped)
+    munmap(const_cast<char*>(data), length);
+}
@@ -0,0 +1,38 @@
+#include <string>
+#include <cstddef>
+
+#pragma once
+
+/**
+ * A read-only memory mapping of a whole file
+ */
+class MappedFile {
+  const char *data = nullptr;
+  std::size_t length = 0;
+  bool mapped = false, opened = false;
+public:
+  /**
+   * Maps a file into memory
+   * @param path the path of the file
+   */
+  MappedFile(const std::string &path);
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  /**
+   * @return true iff the file could be opened and mapped
+   */
+  inline bool is_open() const {return opened;}
+  /**
+   * @return a pointer to the first byte of the file
+   */
+  inline const char *begin() const {return data;}
+  /**
+   * @return a pointer behind the last byte of the file
+   */
+  inline const char *end() const {return data + length;}
+  /**
+   * @return the size of the file in bytes
+   */
+  inline std::size_t size() const {return length;}
+};
@@ -1,56 +1,333 @@
-#include <unordered_map>
 #include <iostream>
+#include <iterator>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <thread>
 
 #include "parser.h"
+#include "mapped_file.h"
 
-void parseTGF(AAF&aaf, std::istream &file) {
-  std::unordered_map<std::string, Argument> argids;
+namespace {
 
-  int id = -1;
-  while ( ! file.eof()) {
-    std::string line;
-    file >> line;
-      if(line.find("#") != std::string::npos) {
-        break;
-      } else {
-        Argument arg = {++id, line};
-        argids[line] = arg;
-        aaf.args.push_back(arg);
+  inline bool is_space(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+  }
+
+  /**
+   * A hash index which maps labels to argument ids. Labels are not stored in the
+   * index, instead they are compared against the label buffer of the AAF.
+   */
+  class LabelIndex {
+    struct Slot {
+      std::uint32_t hash;
+      arg_t id;
+    };
+    AAF &aaf;
+    /**
+     * the buffer which contains all labels of the AAF
+     */
+    const char * const base;
+    std::vector<Slot> slots;
+    std::size_t mask;
+
+    static std::uint32_t hash(const char *str, int len) {
+      std::uint32_t h = 2166136261u;
+      for (int i = 0; i < len; i++) {
+        h ^= (unsigned char)str[i];
+        h *= 16777619u;
       }
+      return h;
+    }
+
+    inline bool matches(const Slot &slot, std::uint32_t h, const char *str, int len) const {
+      const Argument &arg = aaf.args[slot.id];
+      return slot.hash == h && arg.label_len == len
+        && !std::memcmp(base + arg.label_offset, str, len);
+    }
+
+    void grow() {
+      std::vector<Slot> old (slots.size() * 2, Slot {0, -1});
+      old.swap(slots);
+      mask = slots.size() - 1;
+      for (const Slot &slot : old) {
+        if (slot.id < 0)
+          continue;
+        std::size_t i = slot.hash & mask;
+        while (slots[i].id >= 0)
+          i = (i + 1) & mask;
+        slots[i] = slot;
+      }
+    }
+
+  public:
+    /**
+     * Creates an empty index
+     * @param aaf  the AAF whose arguments are indexed
+     * @param base the buffer which contains the labels
+     */
+    LabelIndex(AAF &aaf, const char *base)
+      : aaf(aaf), base(base), slots(1024, Slot {0, -1}), mask(1023) {}
+
+    /**
+     * Looks up a label
+     * @param  str the label
+     * @param  len the length of the label
+     * @return     the id of the argument or -1 if it does not exist
+     */
+    arg_t find(const char *str, int len) const {
+      const std::uint32_t h = hash(str, len);
+      for (std::size_t i = h & mask; slots[i].id >= 0; i = (i + 1) & mask) {
+        if (matches(slots[i], h, str, len))
+          return slots[i].id;
+      }
+      return -1;
+    }
+
+    /**
+     * Looks up a label and adds a new argument to the AAF if it does not exist
+     * @param  str the label, which has to lie within the label buffer
+     * @param  len the length of the label
+     * @return     the id of the argument
+     */
+    arg_t intern(const char *str, int len) {
+      const std::uint32_t h = hash(str, len);
+      std::size_t i = h & mask;
+      for (; slots[i].id >= 0; i = (i + 1) & mask) {
+        if (matches(slots[i], h, str, len))
+          return slots[i].id;
+      }
+      const arg_t id = aaf.args.size();
+      aaf.args.push_back(Argument {id, (std::size_t)(str - base), len});
+      slots[i] = Slot {h, id};
+      if (2 * aaf.args.size() > slots.size())
+        grow();
+      return id;
+    }
+  };
+
+  /**
+   * Removes leading and trailing whitespace from a token
+   */
+  inline void trim(const char *&begin, const char *&end) {
+    while (begin < end && is_space(*begin))
+      begin++;
+    while (end > begin && is_space(end[-1]))
+      end--;
   }
 
-  while ( ! file.eof()) {
-      std::string a,b;
-      file >> a >> b;
-      if(a==""||b=="")
+  /**
+   * Tokenizes a tgf document in place
+   * @param aaf  the AAF to be populated
+   * @param base the document, which also serves as label buffer
+   * @param size the size of the document
+   */
+  void scanTGF(AAF &aaf, const char *base, std::size_t size) {
+    LabelIndex index (aaf, base);
+    const char *pos = base, * const end = base + size;
+
+    auto next_token = [&](const char *&tok, int &len) {
+      while (pos < end && is_space(*pos))
+        pos++;
+      tok = pos;
+      while (pos < end && !is_space(*pos))
+        pos++;
+      len = pos - tok;
+      return len > 0;
+    };
+
+    const char *tok;
+    int len;
+    while (next_token(tok, len)) {
+      if (std::memchr(tok, '#', len))
         break;
-      Attack att = {argids[a], argids[b]};
-      aaf.atts.push_back(att);
+      index.intern(tok, len);
+    }
+
+    const char *tok_b;
+    int len_b;
+    while (next_token(tok, len) && next_token(tok_b, len_b)) {
+      const arg_t a = index.find(tok, len), b = index.find(tok_b, len_b);
+      if (a >= 0 && b >= 0)
+        aaf.atts.push_back(Attack {a, b});
+    }
   }
 
-}
+  /**
+   * Tokenizes the statements of an apx document in place
+   * @param pos    the beginning of the document
+   * @param end    the end of the document
+   * @param on_arg is called with the bounds of the label of every declared argument
+   * @param on_att is called with the bounds of both labels of every attack
+   */
+  template<class ArgHandler, class AttHandler>
+  void scanStatements(const char *pos, const char * const end, ArgHandler on_arg, AttHandler on_att) {
+    while (true) {
+      while (pos < end && is_space(*pos))
+        pos++;
+      if (pos == end)
+        break;
+      const char *key = pos;
+      while (pos < end && *pos != '(' && *pos != '\n')
+        pos++;
+      const char *key_end = pos;
+      if (pos < end && *pos == '(')
+        pos++;
+      const char *content = pos;
+      while (pos < end && *pos != ')' && *pos != '\n')
+        pos++;
+      if (key_end < end && *key_end == '(' && pos < end && *pos == ')') {
+        const char *content_end = pos;
+        trim(key, key_end);
+        if (key_end - key == 3 && !std::memcmp(key, "arg", 3)) {
+          trim(content, content_end);
+          on_arg(content, content_end);
+        } else if (key_end - key == 3 && !std::memcmp(key, "att", 3)) {
+          const char *comma = (const char*) std::memchr(content, ',', content_end - content);
+          if (comma) {
+            const char *a = content, *a_end = comma, *b = comma + 1, *b_end = content_end;
+            trim(a, a_end);
+            trim(b, b_end);
+            on_att(a, a_end, b, b_end);
+          }
+        }
+      }
+      while (pos < end && *pos != '.' && *pos != '\n')
+        pos++;
+      if (pos < end)
+        pos++;
+    }
+  }
 
-void parseAPX(AAF&aaf, std::istream &file) {
-  std::unordered_map<std::string, Argument> argids;
-
-  int id = -1;
-  while ( ! file.eof()) {
-    std::string line;
-    std::getline(file, line);
-    auto parenpos1 =  line.find("("),
-      parenpos2 = line.find(")");
-    std::string type = line.substr(0, parenpos1);
-    if (type == "arg") {
-      std::string label = line.substr(parenpos1+1, parenpos2-parenpos1-1);
-      Argument arg = {++id, label};
-      argids[label] = arg;
-      aaf.args.push_back(arg);
-    } else if (type == "att") {
-      auto commapos = line.find(",");
-      std::string atter = line.substr(parenpos1+1, commapos-parenpos1-1),
-         atted = line.substr(commapos+1, parenpos2-commapos-1);;
-      Attack att = {argids[atter], argids[atted]};
-      aaf.atts.push_back(att);
+  /**
+   * Tokenizes an apx document in place. Attacks may refer to arguments which are
+   * declared later on.
+   * @param aaf  the AAF to be populated
+   * @param base the document, which also serves as label buffer
+   * @param size the size of the document
+   */
+  void scanAPX(AAF &aaf, const char *base, std::size_t size) {
+    LabelIndex index (aaf, base);
+    /**
+     * attacks whose arguments were unknown when they were read
+     */
+    std::vector<const char*> pending;
+
+    scanStatements(base, base + size,
+      [&](const char *label, const char *label_end) {
+        index.intern(label, label_end - label);
+      },
+      [&](const char *a, const char *a_end, const char *b, const char *b_end) {
+        const arg_t atter = index.find(a, a_end - a), atted = index.find(b, b_end - b);
+        if (atter >= 0 && atted >= 0)
+          aaf.atts.push_back(Attack {atter, atted});
+        else
+          pending.insert(pending.end(), {a, a_end, b, b_end});
+      });
+
+    for (std::size_t i = 0; i < pending.size(); i += 4) {
+      const arg_t atter = index.find(pending[i], pending[i+1] - pending[i]),
+        atted = index.find(pending[i+2], pending[i+3] - pending[i+2]);
+      if (atter >= 0 && atted >= 0)
+        aaf.atts.push_back(Attack {atter, atted});
     }
   }
+
+  /**
+   * Tokenizes an apx document in place using several threads. The document is split
+   * into chunks at line boundaries. Every thread collects the arguments of its chunk,
+   * then the arguments are numbered in chunk order, so that ids match those assigned
+   * by scanAPX. Finally every thread resolves the attacks of its chunk.
+   * @param aaf     the AAF to be populated
+   * @param base    the document, which also serves as label buffer
+   * @param size    the size of the document
+   * @param threads the number of threads
+   */
+  void scanAPXParallel(AAF &aaf, const char *base, std::size_t size, int threads) {
+    const char * const end = base + size;
+    std::vector<const char*> bounds {base};
+    for (int i = 1; i < threads; i++) {
+      const char *pos = std::max(bounds.back(), base + size / threads * i);
+      while (pos < end && *pos != '\n')
+        pos++;
+      bounds.push_back(pos < end ? pos + 1 : end);
+    }
+    bounds.push_back(end);
+
+    std::vector<std::vector<const char*>> chunk_args (threads);
+    std::vector<std::vector<Attack>> chunk_atts (threads);
+    auto run = [&](std::function<void(int)> task) {
+      std::vector<std::thread> workers;
+      for (int i = 0; i < threads; i++)
+        workers.emplace_back(task, i);
+      for (auto &worker : workers)
+        worker.join();
+    };
+
+    run([&](int chunk) {
+      auto &labels = chunk_args[chunk];
+      scanStatements(bounds[chunk], bounds[chunk+1],
+        [&](const char *label, const char *label_end) {
+          labels.push_back(label);
+          labels.push_back(label_end);
+        },
+        [](const char*, const char*, const char*, const char*) {});
+    });
+
+    LabelIndex index (aaf, base);
+    for (auto &labels : chunk_args) {
+      for (std::size_t i = 0; i < labels.size(); i += 2)
+        index.intern(labels[i], labels[i+1] - labels[i]);
+      std::vector<const char*>().swap(labels);
+    }
+
+    run([&](int chunk) {
+      auto &atts = chunk_atts[chunk];
+      scanStatements(bounds[chunk], bounds[chunk+1],
+        [](const char*, const char*) {},
+        [&](const char *a, const char *a_end, const char *b, const char *b_end) {
+          const arg_t atter = index.find(a, a_end - a), atted = index.find(b, b_end - b);
+          if (atter >= 0 && atted >= 0)
+            atts.push_back(Attack {atter, atted});
+        });
+    });
+
+    std::size_t att_cnt = 0;
+    for (auto &atts : chunk_atts)
+      att_cnt += atts.size();
+    aaf.atts.reserve(att_cnt);
+    for (auto &atts : chunk_atts) {
+      aaf.atts.insert(aaf.atts.end(), atts.begin(), atts.end());
+      std::vector<Attack>().swap(atts);
+    }
+  }
+}
+
+void parseTGF(AAF&aaf, std::istream &file) {
+  aaf.label_store.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  scanTGF(aaf, aaf.label_store.data(), aaf.label_store.size());
+}
+
+void parseAPX(AAF&aaf, std::istream &file) {
+  aaf.label_store.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  scanAPX(aaf, aaf.label_store.data(), aaf.label_store.size());
+}
+
+bool loadAAF(AAF&aaf, const std::string &path, const std::string &format, int threads) {
+  std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(path);
+  if (!file->is_open())
+    return false;
+  aaf.source = file;
+  /**
+   * small files are not worth spawning threads
+   */
+  threads = std::min<std::size_t>(threads, file->size() / (1 << 20) + 1);
+  if (format == "apx" && threads > 1)
+    scanAPXParallel(aaf, file->begin(), file->size(), threads);
+  else if (format == "apx")
+    scanAPX(aaf, file->begin(), file->size());
+  else
+    scanTGF(aaf, file->begin(), file->size());
+  return true;
 }
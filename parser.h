@@ -13,3 +13,14 @@ void parseTGF(AAF&aaf, std::istream &file) ;
  * @param file the source file
  */
 void parseAPX(AAF&aaf, std::istream &file) ;
+
+/**
+ * Parse an AAF from a memory mapped tgf or apx file, labels are not copied but
+ * refer to the mapping, which is kept alive by the AAF
+ * @param  aaf     the AAF
+ * @param  path    the path of the source file
+ * @param  format  either apx or tgf
+ * @param  threads the number of threads used to parse apx files
+ * @return         false iff the file could not be mapped
+ */
+bool loadAAF(AAF&aaf, const std::string &path, const std::string &format, int threads = 1) ;
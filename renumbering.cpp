@@ -0,0 +1,104 @@
+#include "renumbering.h"
+#include "heuristic.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+  /**
+   * Orders the arguments by breadth first search on the undirected attack graph,
+   * every connected component is started from its argument of least degree
+   * @param ar        the attack relation
+   * @param by_degree visit the neighbours of an argument in ascending order of
+   *                  their degree as done by the Cuthill-McKee algorithm
+   */
+  std::vector<arg_t> breadth_first(const AttackRelation &ar, bool by_degree) {
+    const int n = ar.arg_cnt;
+    auto degree = [&ar](arg_t arg) {return ar.indegree(arg) + ar.outdegree(arg);};
+    std::vector<arg_t> roots (n);
+    std::iota(roots.begin(), roots.end(), 0);
+    std::stable_sort(roots.begin(), roots.end(), [&](arg_t a, arg_t b) {return degree(a) < degree(b);});
+
+    std::vector<arg_t> order;
+    order.reserve(n);
+    std::vector<bool> visited (n, false);
+    for (arg_t root : roots) {
+      if (visited[root])
+        continue;
+      visited[root] = true;
+      order.push_back(root);
+      for (std::size_t head = order.size() - 1; head < order.size(); head++) {
+        const arg_t arg = order[head];
+        const std::size_t first = order.size();
+        for (auto neighbours : {ar.attacked_set(arg), ar.attacker_set(arg)})
+          for (arg_t neighbour : neighbours)
+            if (!visited[neighbour]) {
+              visited[neighbour] = true;
+              order.push_back(neighbour);
+            }
+        if (by_degree)
+          std::stable_sort(order.begin() + first, order.end(),
+            [&](arg_t a, arg_t b) {return degree(a) < degree(b);});
+      }
+    }
+    return order;
+  }
+}
+
+std::vector<arg_t> locality_order(const AttackRelation &ar, const std::string &method) {
+  if (method == "bfs") {
+    return breadth_first(ar, false);
+  } else if (method == "rcm") {
+    auto order = breadth_first(ar, true);
+    std::reverse(order.begin(), order.end());
+    return order;
+  } else if (method == "scc") {
+    /**
+     * Tarjan's algorithm numbers the SCCs in reverse topological order
+     */
+    auto sccs = ar.analysis.sccs.size() ? ar.analysis.sccs : compute_sccs(ar);
+    auto order = breadth_first(ar, false);
+    std::stable_sort(order.begin(), order.end(), [&](arg_t a, arg_t b) {return sccs[a] > sccs[b];});
+    return order;
+  }
+  return std::vector<arg_t>();
+}
+
+AttackRelation * renumber(AAF &aaf, const AttackRelation &ar, const std::vector<arg_t> &order) {
+  const int n = order.size();
+  std::vector<arg_t> new_ids (n);
+  for (arg_t i = 0; i < n; i++)
+    new_ids[order[i]] = i;
+
+  std::vector<Argument> args (n);
+  std::vector<arg_t> origin (n);
+  for (arg_t i = 0; i < n; i++) {
+    args[i] = aaf.args[order[i]];
+    args[i].id = i;
+    origin[i] = aaf.origin.size() ? aaf.origin[order[i]] : order[i];
+  }
+  aaf.args.swap(args);
+  aaf.origin.swap(origin);
+  for (Attack &att : aaf.atts)
+    att = Attack {new_ids[att.active], new_ids[att.passive]};
+
+  AttackRelation *renumbered = new AttackRelation(aaf);
+  const AnalysisCache &analysis = ar.analysis;
+  AnalysisCache &renumbered_analysis = renumbered->analysis;
+  renumbered_analysis.has_grounded = analysis.has_grounded;
+  for (arg_t arg : analysis.grounded)
+    renumbered_analysis.grounded.push_back(new_ids[arg]);
+  std::sort(renumbered_analysis.grounded.begin(), renumbered_analysis.grounded.end());
+  if (analysis.sccs.size()) {
+    renumbered_analysis.sccs.resize(n);
+    for (arg_t i = 0; i < n; i++)
+      renumbered_analysis.sccs[i] = analysis.sccs[order[i]];
+  }
+  for (auto &entry : analysis.orders) {
+    auto &renumbered_order = renumbered_analysis.orders[entry.first];
+    for (auto &p : entry.second)
+      renumbered_order.push_back(std::pair<int,double>(new_ids[p.first], p.second));
+  }
+  return renumbered;
+}
@@ -0,0 +1,25 @@
+#include "AAF.h"
+
+#pragma once
+
+/**
+ * Computes an order of the arguments such that arguments which are close in the
+ * attack graph receive close ids. Backtracking algorithms then access their per
+ * argument arrays mostly sequentially.
+ * @param  ar     the attack relation
+ * @param  method either bfs (breadth first search), rcm (reverse Cuthill-McKee) or
+ *                scc (topological order of the SCCs)
+ * @return        the former ids in their new order or an empty vector if the
+ *                method is unknown
+ */
+std::vector<arg_t> locality_order(const AttackRelation &ar, const std::string &method) ;
+
+/**
+ * Renumbers the arguments of an AAF, the arguments keep their labels and their ids
+ * in the source file are remembered in AAF::origin
+ * @param  aaf   the AAF, which is renumbered in place
+ * @param  ar    the attack relation of the AAF
+ * @param  order order[i] is the former id of the argument which is given the id i
+ * @return       the renumbered attack relation including its cached analyses
+ */
+AttackRelation * renumber(AAF &aaf, const AttackRelation &ar, const std::vector<arg_t> &order) ;
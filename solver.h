@@ -1,18 +1,36 @@
 #include "AAF.h"
 #include "heuristic.h"
+#include "extension_store.h"
+
+#include <atomic>
+#include <functional>
+#include <string>
+
+class ExtensionCollector;
 
 /**
  * An interface for solvers for abstract argumentation problems
  */
 class Solver {
+protected:
+  /**
+   * a flag by which another thread may cancel the solver, or null
+   */
+  const std::atomic<bool> *cancelled = nullptr;
 public:
+  virtual ~Solver() {}
+  /**
+   * Lets the solver stop early once a flag is set, its result is meaningless then
+   * @param flag the flag or null
+   */
+  inline void cancel_with(const std::atomic<bool> *flag) {cancelled = flag;}
   /**
    * Enumerates extensions
    * @param  ar      the attack relation of the underlying AAF
    * @param  max_cnt number of needed extensions, will stop after enough are found
    * @return         extensions of the AAF
    */
-  virtual auto enum_exts (const AttackRelation &ar, int max_cnt = 0) -> std::vector<std::vector<int>> = 0;
+  virtual auto enum_exts (const AttackRelation &ar, int max_cnt = 0) -> ExtensionStore = 0;
   /**
    * Dtermines whether an argument is justified
    * @param  ar        the attack relation of the underlying AAF
@@ -21,20 +39,92 @@ public:
    * @return           true iff the argument is justified
    */
   virtual bool justify (const AttackRelation &ar, arg_t arg, bool sceptical) = 0;
+  /**
+   * Counts extensions, by default by enumerating them
+   * @param  ar      the attack relation of the underlying AAF
+   * @return         the number of extensions of the AAF
+   */
+  virtual std::uint64_t count_exts (const AttackRelation &ar) {return enum_exts(ar).size();}
+  /**
+   * Enumerates all extensions and reports every one as soon as it is found, by
+   * default after enumerating them. Only the overrides which report from the search
+   * itself take constant memory, the default keeps all extensions in an
+   * ExtensionStore until the enumeration ends, which is the case for grounded
+   * semantics. The preferred solver reports early but keeps every maximal extension
+   * in a SetTrie to filter out the non-maximal ones.
+   * @param  ar      the attack relation of the underlying AAF
+   * @param  results the collector to which the extensions are reported, it may
+   *                 stop the enumeration
+   */
+  virtual void report_exts (const AttackRelation &ar, ExtensionCollector &results);
 };
 
 /**
- * A solver for grounded semantics
+ * Counts the extensions of an AAF under complete, preferred or stable semantics.
+ * Extensions are counted separately for every weakly connected component and the
+ * counts are multiplied. Components are searched in the order of a static
+ * heuristic, a dynamic one is applied to the whole AAF instead.
+ * @param  ar        the attack relation of the AAF
+ * @param  heuristic the heuristic
+ * @param  create    creates a solver which uses a given heuristic
+ * @return           the number of extensions in decimal notation
+ */
+std::string count_by_components(const AttackRelation &ar, Heuristic &heuristic,
+    const std::function<Solver * (Heuristic &)> &create);
+
+/**
+ * A solver for grounded semantics. The solver keeps the grounded labelling it
+ * computed last. If the attack relation is changed afterwards, the labelling is
+ * repaired starting from the changed arguments instead of being recomputed.
  */
 class GroundedSolver : public Solver {
+  const int threads;
+  /**
+   * the attack relation the labelling belongs to and the number of its changes
+   * which the labelling reflects
+   */
+  const AttackRelation *tracked = nullptr;
+  std::size_t synced = 0;
+  std::vector<label_t> labelling;
+  /**
+   * the order in which labels were derived, every IN argument is derived after its
+   * attackers and every OUT argument after one of its IN attackers
+   */
+  std::vector<int> derived;
+  int clock = 0;
+  /**
+   * scratch space for repairs
+   */
+  std::vector<int> undefeated;
+  std::vector<bool> visited;
+
+  void compute(const AttackRelation &ar);
+  /**
+   * Computes the grounded labelling from scratch
+   * @param  ar    the attack relation
+   * @param  query an argument whose label ends the computation early or -1
+   * @return       the label of the query, UNDEC if the labelling is complete
+   */
+  label_t propagate(const AttackRelation &ar, arg_t query);
+  /**
+   * Computes the grounded labelling from scratch using several threads, the query
+   * is only checked after every round
+   */
+  label_t propagate_parallel(const AttackRelation &ar, arg_t query);
+  void repair(const AttackRelation &ar);
+  void sync(const AttackRelation &ar);
 public:
+  /**
+   * @param threads the number of threads used to compute labellings from scratch
+   */
+  GroundedSolver(int threads = 1) : threads(threads) {}
   /**
    * Computes the grounded extension
    * @param  ar      the attack relation of the underlying AAF
    * @return         the grouded extension
    */
   std::vector<int> find_ext(const AttackRelation &ar);
-  auto enum_exts (const AttackRelation &ar, int max_cnt = 0) -> std::vector<std::vector<int>> override;
+  auto enum_exts (const AttackRelation &ar, int max_cnt = 0) -> ExtensionStore override;
   bool justify (const AttackRelation &ar, arg_t arg, bool sceptical) override;
 };
 
@@ -43,14 +133,19 @@ public:
  */
 class StableSolver : public Solver {
   Heuristic &heuristic;
+  const int threads;
 public:
   /**
    * Creates a new solver
    * @param  heuristic  the heuristic used by the solver
+   * @param  threads    the number of threads which search in parallel, only used
+   *                    with static heuristics
    */
-  StableSolver(Heuristic &heuristic):heuristic(heuristic){}
-  auto enum_exts (const AttackRelation &ar, int max_cnt = 0) -> std::vector<std::vector<int>> override;
+  StableSolver(Heuristic &heuristic, int threads = 1):heuristic(heuristic), threads(threads){}
+  auto enum_exts (const AttackRelation &ar, int max_cnt = 0) -> ExtensionStore override;
   bool justify (const AttackRelation &ar, arg_t arg, bool sceptical) override;
+  std::uint64_t count_exts (const AttackRelation &ar) override;
+  void report_exts (const AttackRelation &ar, ExtensionCollector &results) override;
 };
 
 /**
@@ -64,8 +159,10 @@ public:
    * @param  heuristic  the heuristic used by the solver
    */
   CompleteSolver(Heuristic &heuristic):heuristic(heuristic){}
-  auto enum_exts (const AttackRelation &ar, int max_cnt = 0) -> std::vector<std::vector<int>> override;
+  auto enum_exts (const AttackRelation &ar, int max_cnt = 0) -> ExtensionStore override;
   bool justify (const AttackRelation &ar, arg_t arg, bool sceptical) override;
+  std::uint64_t count_exts (const AttackRelation &ar) override;
+  void report_exts (const AttackRelation &ar, ExtensionCollector &results) override;
 };
 
 /**
@@ -79,6 +176,62 @@ public:
    * @param  heuristic  the heuristic used by the solver
    */
   PreferredSolver(Heuristic &heuristic):heuristic(heuristic){}
-  auto enum_exts (const AttackRelation &ar, int max_cnt = 0) -> std::vector<std::vector<int>> override;
+  auto enum_exts (const AttackRelation &ar, int max_cnt = 0) -> ExtensionStore override;
+  bool justify (const AttackRelation &ar, arg_t arg, bool sceptical) override;
+  std::uint64_t count_exts (const AttackRelation &ar) override;
+  void report_exts (const AttackRelation &ar, ExtensionCollector &results) override;
+};
+
+/**
+ * A solver for stable, complete and preferred semantics which decomposes the AAF
+ * into its SCCs. The SCCs are solved one after another in topological order, each
+ * one conditioned on the labels of the arguments of preceding SCCs which attack
+ * it, and the partial extensions are combined. The extensions of an SCC are reused
+ * whenever its attackers are labelled the same way again.
+ */
+class SCCSolver : public Solver {
+public:
+  /**
+   * the semantics by which every SCC is solved
+   */
+  enum semantics_t {STABLE, COMPLETE, PREFERRED};
+private:
+  const semantics_t semantics;
+  Heuristic &heuristic;
+  const int threads;
+public:
+  /**
+   * Creates a new solver
+   * @param  semantics  the semantics
+   * @param  heuristic  a static heuristic, every SCC is searched in its order
+   * @param  threads    the number of threads which search an SCC in parallel, only
+   *                    used with stable semantics
+   */
+  SCCSolver(semantics_t semantics, Heuristic &heuristic, int threads = 1)
+    : semantics(semantics), heuristic(heuristic), threads(threads) {}
+  auto enum_exts (const AttackRelation &ar, int max_cnt = 0) -> ExtensionStore override;
+  bool justify (const AttackRelation &ar, arg_t arg, bool sceptical) override;
+  std::uint64_t count_exts (const AttackRelation &ar) override;
+  void report_exts (const AttackRelation &ar, ExtensionCollector &results) override;
+};
+
+/**
+ * A solver which races several solvers, e.g. with different heuristics, on separate
+ * threads. The first one which finds a single extension or justifies an argument
+ * wins and the others are cancelled. Enumerating all extensions is left to the
+ * first solver.
+ */
+class PortfolioSolver : public Solver {
+  std::vector<Solver*> solvers;
+public:
+  /**
+   * Creates a new solver
+   * @param  solvers  the solvers, which are owned by the portfolio from then on
+   */
+  PortfolioSolver(const std::vector<Solver*> &solvers) : solvers(solvers) {}
+  ~PortfolioSolver();
+  auto enum_exts (const AttackRelation &ar, int max_cnt = 0) -> ExtensionStore override;
   bool justify (const AttackRelation &ar, arg_t arg, bool sceptical) override;
+  std::uint64_t count_exts (const AttackRelation &ar) override;
+  void report_exts (const AttackRelation &ar, ExtensionCollector &results) override;
 };
@@ -1,37 +1,103 @@
 #include "solver.h"
 #include "collector.h"
+#include "trail.h"
 
 #include <iostream>
-#include <stack>
+#include <algorithm>
+#include <cstdlib>
 
 
 
 namespace {
 
-  class MaximalFilter : public ExtensionCollector {
+  /**
+   * A set of extensions, stored as sorted id sequences in a trie, where extensions
+   * with a common prefix share their nodes. An extension is contained in a stored
+   * one iff there is a path from the root which visits its arguments in order, where
+   * a path may skip arguments smaller than the next one sought, but none greater
+   * than it.
+   */
+  class SetTrie {
+    /**
+     * A node of the trie, its children form a list sorted by argument
+     */
+    struct Node {
+      arg_t arg;
+      int child, sibling;
+    };
+    std::vector<Node> nodes {{-1, -1, -1}};
+    std::vector<std::pair<int,int>> stack;
+  public:
+    /**
+     * @param  ext a sorted extension
+     * @return     true iff the extension is contained in a stored one
+     */
+    bool is_contained(const std::vector<arg_t> &ext) {
+      if (nodes[0].child < 0)
+        return false;
+      stack.clear();
+      stack.push_back({0, 0});
+      while (!stack.empty()) {
+        int node = stack.back().first, matched = stack.back().second;
+        stack.pop_back();
+        if (matched == ext.size())
+          return true;
+        for (int child = nodes[node].child; child >= 0 && nodes[child].arg <= ext[matched]; child = nodes[child].sibling)
+          stack.push_back({child, nodes[child].arg == ext[matched] ? matched + 1 : matched});
+      }
+      return false;
+    }
+
+    /**
+     * @param ext a sorted extension to be stored
+     */
+    void insert(const std::vector<arg_t> &ext) {
+      int node = 0;
+      for (arg_t arg : ext) {
+        int *link = &nodes[node].child;
+        while (*link >= 0 && nodes[*link].arg < arg)
+          link = &nodes[*link].sibling;
+        if (*link < 0 || nodes[*link].arg != arg) {
+          int next = *link;
+          *link = nodes.size();
+          node = *link;
+          nodes.push_back({arg, -1, next});
+        } else node = *link;
+      }
+    }
+  };
+
+  /**
+   * Passes on only those extensions which are not contained in an extension that
+   * was passed on before
+   */
+  class MaximalFilter final : public ExtensionCollector {
     ExtensionCollector &collector;
-    std::vector<labelling_t> ext_labellings;
+    SetTrie passed;
+    std::vector<arg_t> ext;
   public:
-    MaximalFilter (ExtensionCollector &collector) :collector(collector) {}
+    MaximalFilter (ExtensionCollector &collector) :collector(collector) {follow(collector);}
     void report_ext_labelling (const labelling_t &labels) {
-      std::vector<int> ext;
+      ext.clear();
       for (int i = 0; i<labels.size(); i++) {
         if(labels[i] == labels::IN)
           ext.push_back(i);
       }
-      for (auto &ext_labelling : ext_labellings) {
-        bool included = true;
-        for (int arg : ext) {
-          if (ext_labelling[arg] != labels::IN) {
-            included = false;
-            break;
-          }
-        }
-        if (included) {
-          return;
-        }
-      }
-      ext_labellings.push_back(labels);
+      pass(labels);
+    }
+    void report_ext_labelling (const labelling_t &labels, const std::vector<int> &in_args) {
+      ext.assign(in_args.begin(), in_args.end());
+      std::sort(ext.begin(), ext.end());
+      pass(labels);
+    }
+  private:
+    /**
+     * Passes on the sorted extension in ext unless it is contained in one passed before
+     */
+    void pass(const labelling_t &labels) {
+      if (passed.is_contained(ext))
+        return;
+      passed.insert(ext);
       collector.report_ext_labelling(labels, ext);
       if (collector.is_stopped())
         stop();
@@ -60,33 +126,47 @@ class CompleteEnumerator : HeuristicAlgorithm {
    */
   bool *defended;
   /**
-   * Stacks which keep track of all taken decision sin case they have to be reverted
+   * The labels taken so far, in case they have to be reverted
    */
-  std::stack<int> decisions_index, decisions_arg;
+  Trail trail;
   /**
-   * Counters which keep track of the the size of the solution and the share of defended_cnt
-   * arguments
+   * The number of defended arguments
    */
-  int in_cnt = 0, defended_cnt = 0;//, out_cnt = 0;
+  int defended_cnt = 0;
+  /**
+   * The number of arguments which attack an IN argument but are not attacked by
+   * one, the IN arguments are admissible iff there is none
+   */
+  int unrefuted = 0;
+  /**
+   * The values of defended_cnt and unrefuted before every position of the trail
+   */
+  std::vector<int> defended_at, unrefuted_at;
+  /**
+   * The memory of pos_range, neg_range and agressor_cnt in this order, changes
+   * of these counters are logged on the trail by their position in it
+   */
+  int *counters;
 
   /**
-   * These fields allow it to adopt the algorithm for preferred semantics
+   * This field allows it to adopt the algorithm for preferred semantics
    */
-  const bool preferred;
   bool poss_max = true;
 
 public:
   /**
    * Creates a new Complete/Preferred Algorithm
    * @param ar        the AAF given as an attack relation
-   * @param preferred if this is true the algorithm will find only preferred extensions
    */
-  CompleteEnumerator(const AttackRelation &ar, bool preferred = false)
-      : ar(ar), n(ar.arg_cnt), preferred(preferred)  {
+  CompleteEnumerator(const AttackRelation &ar)
+      : ar(ar), n(ar.arg_cnt), trail(ar.arg_cnt, 3 * ar.attack_cnt() + 1)  {
     labels = labelling_t(n, BLANK);
-    pos_range = new int [n]();
-    neg_range = new int [n]();
-    agressor_cnt = new int [n];
+    defended_at.resize(n);
+    unrefuted_at.resize(n);
+    counters = new int [3 * n]();
+    pos_range = counters;
+    neg_range = counters + n;
+    agressor_cnt = counters + 2 * n;
     for (int i = 0; i < n ; i++) {
       agressor_cnt[i] = ar.indegree(i);
       if (agressor_cnt[i] == 0)
@@ -95,9 +175,16 @@ public:
   }
 
   ~CompleteEnumerator() {
-    delete[] pos_range;
-    delete[] neg_range;
-    delete[] agressor_cnt;
+    delete[] counters;
+  }
+
+  /**
+   * Pushes a label onto the trail
+   */
+  inline void record(arg_t arg, int index, bool in = false) {
+    defended_at[trail.size()] = defended_cnt;
+    unrefuted_at[trail.size()] = unrefuted;
+    trail.push(arg, index, in);
   }
 
   /**
@@ -108,24 +195,29 @@ public:
    */
   bool set_in (arg_t arg, int index) {
     labels[arg] = IN;
-    in_cnt ++;
-    decisions_index.push(index);
-    decisions_arg.push(arg);
+    record(arg, index, true);
     poss_max = true;
     for (arg_t atter : ar.attacker_set(arg)) {
-      neg_range[atter] ++;
+      trail.log(n + atter);
+      if (neg_range[atter]++ == 0 && pos_range[atter] == 0)
+        unrefuted ++;
     }
+    const std::size_t logged = trail.logged();
     for (arg_t atted : ar.attacked_set(arg)) {
       pos_range[atted] ++;
-      if (pos_range[atted] == 1)
+      trail.log(atted);
+      if (pos_range[atted] == 1) {
+        if (neg_range[atted] > 0)
+          unrefuted --;
         for (arg_t attedatted : ar.attacked_set(atted)) {
-          agressor_cnt[attedatted]--;
-          if (agressor_cnt[attedatted] == 0)
+          const bool defended = --agressor_cnt[attedatted] == 0;
+          trail.log(2 * n + attedatted, defended);
+          if (defended)
             defended_cnt ++;
         }
+      }
     }
-//    if (neg_range[arg] > 0)
-  //    return false;
+    const std::size_t end = trail.logged();
     for (arg_t atter : ar.attacker_set(arg)) {
       if(!set_out(atter))
         return false;
@@ -134,18 +226,18 @@ public:
           if(!set_out(atted))
             return false;
         }
-    for (arg_t atted : ar.attacked_set(arg)) {
-            if (pos_range[atted] == 1)
-              for (arg_t attedatted : ar.attacked_set(atted)) {
-               if (agressor_cnt[attedatted] == 0) {
-                  if (labels[attedatted] == OUT)
-                    return false;
-                  if (labels[attedatted] == BLANK)
-                    if (!set_in(attedatted, indices::BACKTRACK))
-                      return false;
-                }
-              }
-        }
+    // the arguments which have just become defended are flagged in the log
+    for (std::size_t i = logged; i < end; i++) {
+      const Trail::change_t change = trail.change(i);
+      if (change & 1) {
+        const arg_t attedatted = (change >> 1) - 2 * n;
+        if (labels[attedatted] == OUT)
+          return false;
+        if (labels[attedatted] == BLANK)
+          if (!set_in(attedatted, indices::BACKTRACK))
+            return false;
+      }
+    }
     return true;
   }
 
@@ -156,11 +248,14 @@ public:
    * @return         false if conflicts occured
    */
   bool set_out (arg_t arg, int index = indices::BACKTRACK) {
+    /**
+     * an IN argument which attacks itself or another one
+     */
+    if (labels[arg] == IN)
+      return false;
     if (labels[arg] & BLANK) {
       labels[arg] = labels::OUT;
-    //  out_cnt ++;
-      decisions_index.push(index);
-      decisions_arg.push(arg);
+      record(arg, index);
     }
     if (neg_range[arg] > 0 && pos_range[arg] == 0) {
       int candidate_cnt = 0;
@@ -174,7 +269,7 @@ public:
           if (candidate_cnt == 2)
             break;
         }
-      }
+      }
       if (!candidate_cnt) {
         return false;
       }
@@ -186,7 +281,45 @@ public:
     return true;
   }
 
-  void enumComplete(Heuristic &heuristic, ExtensionCollector &results) {
+  /**
+   * Labels arguments IN which are not labelled yet
+   * @param  args    the arguments
+   * @return         false if conflicts occured
+   */
+  bool assume_in (const std::vector<arg_t> &args) {
+    for (arg_t arg : args) {
+      if (labels[arg] == OUT)
+        return false;
+      if (labels[arg] == BLANK && !set_in(arg, indices::STOP))
+        return false;
+    }
+    return true;
+  }
+
+  /**
+   * Reverts all labels from a position of the trail on, the logged changes of the
+   * counters are undone in bulk and defended_cnt and unrefuted are restored
+   * @param pos the position
+   */
+  void revert(int pos) {
+    if (pos >= trail.size())
+      return;
+    defended_cnt = defended_at[pos];
+    unrefuted = unrefuted_at[pos];
+    const std::uint32_t increased = 2 * n;
+    trail.revert(pos, [this, increased](Trail::change_t change) {
+      const std::uint32_t counter = change >> 1;
+      counters[counter] += counter < increased ? -1 : 1;
+    }, [this](arg_t arg) {
+      labels[arg] = BLANK;
+    });
+  }
+
+  /**
+   * Labels the grounded extension IN and self-attacking arguments OUT
+   * @return false if conflicts occured
+   */
+  bool label_fixed() {
 
     /**
      * Iclude the grounded extension
@@ -194,9 +327,9 @@ public:
     for (arg_t arg : GroundedSolver().find_ext(ar)) {
       if (labels[arg] == BLANK) {
         if(!set_in(arg, indices::STOP))
-          return;
+          return false;
       } else if (labels[arg] == OUT)
-        return;
+        return false;
     }
 
     /**
@@ -204,12 +337,25 @@ public:
      */
     for (arg_t arg : ar.self_attacker_set()) {
       //no return statement, because of empty set
-      if (labels[arg] == BLANK) {
-          if(!set_out(arg, indices::STOP)) {
-            //results.report_ext_labelling()
-          }
-      }
+      if (labels[arg] == BLANK)
+        set_out(arg, indices::STOP);
     }
+    return true;
+  }
+
+  /**
+   * Enumerates complete extensions. The search is instantiated for the semantics,
+   * the order policy and the type of the collector. For preferred semantics a
+   * labelling is only reported if an argument was labelled IN since the last
+   * report, the others are contained in the reported one.
+   * @param order   the policy by which the heuristic is read
+   * @param results the collector to which found extensions are reported
+   */
+  template <bool preferred, class Order, class Collector>
+  void enumComplete(Order &order, Collector &results) {
+
+    if (!label_fixed())
+      return;
 
     /**
      * Step counter, keeps track of the number of taken decisions
@@ -218,22 +364,15 @@ public:
 
     while (true) {
 
-      if ((++index == n)){// || (in_cnt + out_cnt == n)) {
+      if (++index == n) {
         if (preferred && ! poss_max)
           goto backtrack;
-        if (in_cnt != defended_cnt)
+        if (trail.in_args().size() != defended_cnt || unrefuted > 0)
           goto backtrack;
-        for (int i = 0 ; i < n ; i++) {
-          if (neg_range[i] > 0 && pos_range[i] == 0)
-           goto backtrack;
-        }
         poss_max = false;
-        results.report_ext_labelling(labels);
-        if (results.is_stopped()) {
-          break;
-        }
+        results.report_ext_labelling(labels, trail.in_args());
       } else {
-        arg_t arg = heuristic.get(index, *this);
+        arg_t arg = order.get(index, *this);
         if (labels[arg] == BLANK) {
             if (!set_in(arg, index))
               goto backtrack;
@@ -241,37 +380,157 @@ public:
         continue;
       }
 backtrack:
-      /**
-      *     Pop labelling changes from the stack until a decision is reverted
-        */
-      if (decisions_index.empty()) {
+      if (results.is_stopped()) {
         break;
       }
-      index = decisions_index.top();
-      arg_t arg = decisions_arg.top();
-      decisions_index.pop();
-      decisions_arg.pop();
-      if (index == indices::STOP)
+      /**
+       * Revert the current level and flip its decision, no decision is left to be
+       * flipped at level 0
+       */
+      if (trail.level() == 0) {
         break;
-      if (labels[arg] == IN) {
-        in_cnt --;
-        for (arg_t a : ar.attacker_set(arg)) {
-          neg_range[a] --;
+      }
+      const int start = trail.level_start(trail.level());
+      const arg_t arg = trail[start].arg;
+      index = trail[start].index;
+      revert(start);
+      if (!set_out(arg)) {
+        goto backtrack;
+      }
+    }
+
+  }
+
+  /**
+   * Finds a single preferred extension by maximizing the extension SCC by SCC. The
+   * arguments of an SCC are decided under the labels of the preceding SCCs, which are
+   * never revised. The first labelling found for an SCC is maximal, since a decision
+   * for IN is only flipped once no complete labelling is left below it, and a
+   * maximal labelling of an SCC can always be extended to the following SCCs.
+   * @param sequence the arguments SCC by SCC in topological order
+   * @param ends     for every SCC the position in sequence behind its arguments
+   * @param results  the collector to which the extension is reported
+   */
+  template <class Collector>
+  void findPreferred(const std::vector<arg_t> &sequence, const std::vector<int> &ends, Collector &results) {
+
+    if (!label_fixed())
+      return;
+
+    /**
+     * The SCC which is decided and the number of decisions on earlier SCCs
+     */
+    int scc = 0, floor = 0;
+    int index = -1;
+
+    if (ends.empty()) {
+      results.report_ext_labelling(labels, trail.in_args());
+      return;
+    }
+
+    while (!results.is_stopped()) {
+
+      if (++index == ends[scc]) {
+        if (unrefuted > 0)
+          goto backtrack;
+        /**
+         * the defended arguments of the SCC have to be IN, those of the following
+         * SCCs may not be labelled yet
+         */
+        for (int i = scc ? ends[scc - 1] : 0; i < index; i++)
+          if (agressor_cnt[sequence[i]] == 0 && labels[sequence[i]] != IN)
+            goto backtrack;
+        floor = trail.level();
+        if (++scc == ends.size()) {
+          results.report_ext_labelling(labels, trail.in_args());
+          break;
         }
-        for (arg_t a : ar.attacked_set(arg)) {
-          pos_range[a] --;
-          if (pos_range[a] == 0)
-            for (arg_t attedatted : ar.attacked_set(a)) {
-              agressor_cnt[attedatted]++;
-              if (agressor_cnt[attedatted] == 1)
-                defended_cnt --;
-            }
+      }
+      {
+        arg_t arg = sequence[index];
+        if (labels[arg] == BLANK) {
+            if (!set_in(arg, index))
+              goto backtrack;
         }
-      } //else if (labels[arg] == OUT) {
-        //out_cnt --;
-      //}
-      labels[arg] = BLANK;
-      if (index == indices::BACKTRACK || !set_out(arg)) {
+      }
+      continue;
+backtrack:
+      /**
+       * the labels of the preceding SCCs are maximal and can always be extended,
+       * running out of decisions on this SCC is a bug and no empty result
+       */
+      if (trail.level() == floor) {
+        std::cerr << "Fail: no labelling of SCC " << scc << " extends the preferred labelling of the preceding SCCs" << std::endl;
+        std::abort();
+      }
+      const int start = trail.level_start(trail.level());
+      const arg_t arg = trail[start].arg;
+      index = trail[start].index;
+      revert(start);
+      if (!set_out(arg)) {
+        goto backtrack;
+      }
+    }
+
+  }
+
+  /**
+   * Searches an admissible set which contains the IN arguments. As long as an IN
+   * argument has an attacker which is not attacked by one, an argument which
+   * attacks this attacker is decided for IN, and flipped to OUT if no admissible
+   * set is left below. The search neither requires the set to be complete, nor
+   * does it decide arguments which are not needed for its defence.
+   * @param rank    the position of every argument in the order of the heuristic,
+   *                the attackers of an attacker are tried in this order
+   * @param results the collector to which the admissible set is reported
+   */
+  template <class Collector>
+  void findAdmissible(const std::vector<int> &rank, Collector &results) {
+
+    /**
+     * The position on the trail before which all attackers of IN arguments are
+     * attacked by one, for every decision level the position when it was opened
+     */
+    int checked = 0;
+    std::vector<int> checked_at;
+
+    while (!results.is_stopped()) {
+      arg_t atter = -1;
+      while (checked < trail.size() && atter < 0) {
+        const arg_t arg = trail[checked].arg;
+        if (labels[arg] == IN)
+          for (arg_t a : ar.attacker_set(arg))
+            if (pos_range[a] == 0) {
+              atter = a;
+              break;
+            }
+        if (atter < 0)
+          checked ++;
+      }
+      if (atter < 0) {
+        results.report_ext_labelling(labels, trail.in_args());
+        break;
+      }
+      arg_t defender = -1;
+      for (arg_t a : ar.attacker_set(atter))
+        if (labels[a] != OUT && pos_range[a] == 0 && neg_range[a] == 0
+            && (defender < 0 || rank[a] < rank[defender]))
+          defender = a;
+      if (defender < 0)
+        goto backtrack;
+      checked_at.push_back(checked);
+      if (set_in(defender, trail.level()))
+        continue;
+backtrack:
+      if (trail.level() == 0) {
+        break;
+      }
+      const int start = trail.level_start(trail.level());
+      const arg_t arg = trail[start].arg;
+      revert(start);
+      checked = checked_at.back();
+      checked_at.pop_back();
+      if (!set_out(arg)) {
         goto backtrack;
       }
     }
@@ -279,49 +538,224 @@ backtrack:
   }
 };
 
+/**
+ * Enumerates complete or preferred extensions with the order policy which fits the
+ * heuristic
+ * @param enumor    the enumerator
+ * @param heuristic the heuristic
+ * @param results   the collector to which found extensions are reported
+ */
+template <bool preferred, class Collector>
+void enumerate(CompleteEnumerator &enumor, Heuristic &heuristic, Collector &results) {
+  if (heuristic.is_dynamic()) {
+    DynamicOrder order {heuristic};
+    enumor.enumComplete<preferred>(order, results);
+  } else if (heuristic.is_const()) {
+    IdentityOrder order;
+    enumor.enumComplete<preferred>(order, results);
+  } else {
+    StaticOrder order {heuristic};
+    enumor.enumComplete<preferred>(order, results);
+  }
 }
 
-std::vector<std::vector<int>> CompleteSolver::enum_exts(const AttackRelation &ar, int max_cnt) {
-  ExtensionEnumerator results {max_cnt};
+/**
+ * Determines whether an argument is contained in an admissible set, which is the
+ * case iff it is contained in a complete or preferred extension
+ * @param  ar        the attack relation
+ * @param  arg       the argument
+ * @param  heuristic the heuristic
+ * @param  cancelled a flag which cancels the search, or null
+ * @return           true iff the argument is credulously justified
+ */
+bool justify_admissible(const AttackRelation &ar, arg_t arg, const Heuristic &heuristic, const std::atomic<bool> *cancelled) {
+  ArgumentJustifier results {arg, false};
+  results.cancel_with(cancelled);
+  std::vector<int> rank (ar.arg_cnt);
+  const auto &order = heuristic.get_order();
+  for (int i = 0; i < order.size(); i++)
+    rank[order[i].first] = i;
   CompleteEnumerator enumor(ar);
-  enumor.enumComplete(heuristic, results);
+  if(!enumor.set_in(arg, indices::STOP))
+    return false;
+  enumor.findAdmissible(rank, results);
+  return results.is_justified();
+}
+
+/**
+ * Searches a preferred extension which excludes an argument, guided by counterexamples.
+ * The complete extensions which exclude the argument are reported to it, such that
+ * every one which is passed on is maximal among them. Such an extension is preferred
+ * unless a complete extension containing it and the argument exists. In that case
+ * the latter is maximized to a preferred extension. No extension contained in
+ * a candidate or in a preferred extension containing the argument can be a
+ * counterexample, so those are blocked for the rest of the search.
+ */
+class CounterexampleSearch final : public ExtensionCollector {
+  const AttackRelation &ar;
+  /**
+   * the order in which the candidates are maximized, a snapshot of the heuristic,
+   * since a dynamic one is still used by the search for candidates
+   */
+  PrecomputedHeuristic order;
+  const arg_t arg;
+  const std::atomic<bool> *cancelled;
+  SetTrie blocked;
+  std::vector<arg_t> ext;
+  bool found = false;
+public:
+  /**
+   * @param ar        the attack relation
+   * @param heuristic the heuristic of the search
+   * @param arg       the argument to be excluded
+   * @param cancelled a flag which cancels the search, or null
+   */
+  CounterexampleSearch(const AttackRelation &ar, const Heuristic &heuristic, arg_t arg, const std::atomic<bool> *cancelled)
+      : ar(ar), order(heuristic.get_order()), arg(arg), cancelled(cancelled) {
+    cancel_with(cancelled);
+  }
+
+  /**
+   * @return true iff a preferred extension excluding the argument was found
+   */
+  inline bool is_found() const {return found;}
+
+  void report_ext_labelling (const labelling_t &labels) {
+    ext.clear();
+    for (int i = 0; i<labels.size(); i++) {
+      if(labels[i] == IN)
+        ext.push_back(i);
+    }
+    check();
+  }
+
+  void report_ext_labelling (const labelling_t &labels, const std::vector<int> &in_args) {
+    ext.assign(in_args.begin(), in_args.end());
+    std::sort(ext.begin(), ext.end());
+    check();
+  }
+
+private:
+  /**
+   * Checks the sorted candidate in ext unless it is blocked
+   */
+  void check() {
+    if (blocked.is_contained(ext))
+      return;
+    blocked.insert(ext);
+
+    ExtensionEnumerator superset {ar.arg_cnt, 1};
+    superset.cancel_with(cancelled);
+    CompleteEnumerator enumor(ar);
+    StaticOrder sequence {order};
+    if (enumor.set_in(arg, indices::STOP) && enumor.assume_in(ext))
+      enumor.enumComplete<false>(sequence, superset);
+    if (superset.is_stopped() && superset.exts.empty())
+      return;
+    if (superset.exts.empty()) {
+      found = true;
+      stop();
+    } else {
+      blocked.insert(superset.exts[0]);
+    }
+  }
+};
+
+}
+
+ExtensionStore CompleteSolver::enum_exts(const AttackRelation &ar, int max_cnt) {
+  ExtensionEnumerator results {ar.arg_cnt, max_cnt};
+  results.cancel_with(cancelled);
+  CompleteEnumerator enumor(ar);
+  enumerate<false>(enumor, heuristic, results);
   return results.exts;
 }
 
+std::uint64_t CompleteSolver::count_exts(const AttackRelation &ar) {
+  ExtensionCounter results;
+  results.cancel_with(cancelled);
+  CompleteEnumerator enumor(ar);
+  enumerate<false>(enumor, heuristic, results);
+  return results.count;
+}
+
+void CompleteSolver::report_exts(const AttackRelation &ar, ExtensionCollector &results) {
+  CompleteEnumerator enumor(ar);
+  /**
+   * EE prints every extension, so the search is instantiated for the printer to
+   * bind its reports at compile time
+   */
+  if (ExtensionPrinter *printer = dynamic_cast<ExtensionPrinter*>(&results))
+    enumerate<false>(enumor, heuristic, *printer);
+  else
+    enumerate<false>(enumor, heuristic, results);
+}
+
 
 bool CompleteSolver::justify (const AttackRelation &ar, arg_t arg, bool sceptical) {
   if (sceptical) {
     return GroundedSolver().justify(ar, arg, sceptical);
   } else {
-    ArgumentJustifier results {arg, sceptical};
-    CompleteEnumerator enumor(ar);
-    if(!enumor.set_in(arg, indices::STOP))
-      return false;
-    enumor.enumComplete(heuristic, results);
-    return results.is_justified();
+    return justify_admissible(ar, arg, heuristic, cancelled);
   }
 }
 
 
-std::vector<std::vector<int>> PreferredSolver::enum_exts(const AttackRelation &ar, int max_cnt) {
-  ExtensionEnumerator results {max_cnt};
+ExtensionStore PreferredSolver::enum_exts(const AttackRelation &ar, int max_cnt) {
+  ExtensionEnumerator results {ar.arg_cnt, max_cnt};
+  results.cancel_with(cancelled);
+  if (max_cnt == 1) {
+    /**
+     * the SCCs in topological order, Tarjan's algorithm numbers an SCC after all
+     * SCCs it attacks, every SCC in the order of the heuristic
+     */
+    const int n = ar.arg_cnt;
+    const std::vector<int> sccs = ar.analysis.sccs.size() == n ? ar.analysis.sccs : compute_sccs(ar);
+    const int scc_cnt = n ? *std::max_element(sccs.begin(), sccs.end()) + 1 : 0;
+    std::vector<int> ends (scc_cnt, 0);
+    for (arg_t arg = 0; arg < n; arg++)
+      ends[scc_cnt - 1 - sccs[arg]]++;
+    for (int k = 1; k < scc_cnt; k++)
+      ends[k] += ends[k - 1];
+    std::vector<arg_t> sequence (n);
+    std::vector<int> next (scc_cnt, 0);
+    for (int k = 1; k < scc_cnt; k++)
+      next[k] = ends[k - 1];
+    for (auto &p : heuristic.get_order())
+      sequence[next[scc_cnt - 1 - sccs[p.first]]++] = p.first;
+    CompleteEnumerator enumor(ar);
+    enumor.findPreferred(sequence, ends, results);
+    return results.exts;
+  }
   MaximalFilter filter {results};
-  CompleteEnumerator enumor(ar, true);
-  enumor.enumComplete(heuristic, filter);
+  CompleteEnumerator enumor(ar);
+  enumerate<true>(enumor, heuristic, filter);
   return results.exts;
 }
 
+std::uint64_t PreferredSolver::count_exts(const AttackRelation &ar) {
+  ExtensionCounter results;
+  results.cancel_with(cancelled);
+  MaximalFilter filter {results};
+  CompleteEnumerator enumor(ar);
+  enumerate<true>(enumor, heuristic, filter);
+  return results.count;
+}
+
+void PreferredSolver::report_exts(const AttackRelation &ar, ExtensionCollector &results) {
+  MaximalFilter filter {results};
+  CompleteEnumerator enumor(ar);
+  enumerate<true>(enumor, heuristic, filter);
+}
+
 
 bool PreferredSolver::justify (const AttackRelation &ar, arg_t arg, bool sceptical) {
-  ArgumentJustifier results {arg, sceptical};
-  MaximalFilter filter {results};
-  CompleteEnumerator enumor(ar, true);
   if (sceptical) {
-      //nothing, because maxity
-  } else {
-    if(!enumor.set_in(arg, indices::STOP))
-      return false;
+    CounterexampleSearch counterexamples {ar, heuristic, arg, cancelled};
+    CompleteEnumerator enumor(ar);
+    if (enumor.set_out(arg, indices::STOP))
+      enumerate<true>(enumor, heuristic, counterexamples);
+    return !counterexamples.is_found();
   }
-  enumor.enumComplete(heuristic, filter);
-  return results.is_justified();
+  return justify_admissible(ar, arg, heuristic, cancelled);
 }
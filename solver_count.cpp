@@ -0,0 +1,105 @@
+#include "solver.h"
+
+#include <algorithm>
+
+namespace {
+  /**
+   * Counts may exceed 64 bits once they are multiplied, so they are kept as digits
+   * in base 10^9, the least significant first
+   */
+  constexpr std::uint64_t base = 1000000000;
+
+  void multiply(std::vector<std::uint64_t> &digits, std::uint64_t factor) {
+    std::vector<std::uint64_t> factors;
+    for (; factor; factor /= base)
+      factors.push_back(factor % base);
+    std::vector<std::uint64_t> product (digits.size() + factors.size() + 1, 0);
+    for (int j = 0; j < factors.size(); j++) {
+      std::uint64_t carry = 0;
+      for (int i = 0; i < digits.size() || carry; i++) {
+        std::uint64_t cur = product[i + j] + carry + (i < digits.size() ? digits[i] * factors[j] : 0);
+        product[i + j] = cur % base;
+        carry = cur / base;
+      }
+    }
+    while (product.size() > 1 && !product.back())
+      product.pop_back();
+    digits = product;
+  }
+
+  std::string decimal(const std::vector<std::uint64_t> &digits) {
+    std::string str = std::to_string(digits.back());
+    for (int i = digits.size() - 2; i >= 0; i--) {
+      const std::string digit = std::to_string(digits[i]);
+      str += std::string(9 - digit.size(), '0') + digit;
+    }
+    return str;
+  }
+}
+
+std::string count_by_components(const AttackRelation &ar, Heuristic &heuristic,
+    const std::function<Solver * (Heuristic &)> &create) {
+  const int n = ar.arg_cnt;
+  if (heuristic.is_dynamic()) {
+    Solver *solver = create(heuristic);
+    const std::uint64_t count = solver->count_exts(ar);
+    delete solver;
+    return std::to_string(count);
+  }
+
+  /**
+   * the weakly connected components are collected in the order of the heuristic
+   */
+  std::vector<int> component (n, -1);
+  std::vector<std::vector<arg_t>> members;
+  for (auto &p : heuristic.get_order()) {
+    if (component[p.first] >= 0)
+      continue;
+    const int c = members.size();
+    component[p.first] = c;
+    std::vector<arg_t> pending {p.first};
+    while (!pending.empty()) {
+      const arg_t arg = pending.back();
+      pending.pop_back();
+      for (const ArgRange &neighbours : {ar.attacker_set(arg), ar.attacked_set(arg)})
+        for (arg_t neighbour : neighbours)
+          if (component[neighbour] < 0) {
+            component[neighbour] = c;
+            pending.push_back(neighbour);
+          }
+    }
+    members.emplace_back();
+  }
+  for (auto &p : heuristic.get_order())
+    members[component[p.first]].push_back(p.first);
+
+  std::vector<std::uint64_t> count {1};
+  std::vector<arg_t> local (n);
+  for (auto &args : members) {
+    /**
+     * an argument without attacks is IN in every extension
+     */
+    if (args.size() == 1 && ar.attacker_set(args[0]).empty())
+      continue;
+    for (int i = 0; i < args.size(); i++)
+      local[args[i]] = i;
+    std::vector<Attack> atts;
+    for (arg_t arg : args)
+      for (arg_t atted : ar.attacked_set(arg))
+        atts.push_back(Attack {local[arg], local[atted]});
+    AttackRelation sub (args.size(), atts);
+    if (ar.has_bitsets())
+      sub.build_bitsets();
+    /**
+     * the arguments are numbered in the order of the heuristic
+     */
+    ConstHeuristic order (0, args.size());
+    Solver *solver = create(order);
+    const std::uint64_t factor = solver->count_exts(sub);
+    delete solver;
+    multiply(count, factor);
+    if (!factor)
+      break;
+  }
+  return decimal(count);
+}
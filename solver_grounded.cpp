@@ -1,6 +1,18 @@
 #include "solver.h"
 
+#include <algorithm>
+#include <queue>
+#include <climits>
+#include <atomic>
+#include <thread>
+#include <functional>
+
 namespace {
+  /**
+   * the number of arguments or attacks below which work is not split among threads
+   */
+  constexpr int parallel_grain = 1 << 14;
+
   /**
    * Defines the structure of labellings
    */
@@ -15,85 +27,330 @@ namespace {
   }
 }
 
-auto GroundedSolver::enum_exts (const AttackRelation &ar, int max_cnt) -> std::vector<std::vector<int>> {
-  return std::vector<std::vector<int>> (1,find_ext(ar));
+auto GroundedSolver::enum_exts (const AttackRelation &ar, int max_cnt) -> ExtensionStore {
+  ExtensionStore exts (ar.arg_cnt);
+  exts.push_back(find_ext(ar));
+  return exts;
 }
 
 
-// Algorithm to find the grounded extension according to Nofal, Atkinson and Dunne (2014)
 std::vector<int> GroundedSolver::find_ext(const AttackRelation &ar) {
-    using namespace labels;
-    std::vector<label_t> labels (ar.arg_cnt, UNDEC);
-    int * agressor_cnt = new int [ar.arg_cnt];
-    for (int i = 0; i < ar.arg_cnt ; i++) {
-      agressor_cnt[i] = ar.indegree(i);
+  using namespace labels;
+  if (ar.analysis.has_grounded)
+    return ar.analysis.grounded;
+  sync(ar);
+  std::vector<int> ext;
+  for (int i = 0; i<ar.arg_cnt; i++) {
+    if(labelling[i] & IN)
+      ext.push_back(i);
+  }
+  return ext;
+}
+
+void GroundedSolver::sync(const AttackRelation &ar) {
+  if (tracked != &ar || synced > ar.changed_args().size() || clock > INT_MAX - 2 * ar.arg_cnt)
+    compute(ar);
+  else if (synced < ar.changed_args().size())
+    repair(ar);
+}
+
+void GroundedSolver::compute(const AttackRelation &ar) {
+  propagate(ar, -1);
+  tracked = &ar;
+  synced = ar.changed_args().size();
+}
+
+/**
+ * Derives the grounded labelling with a worklist, which takes O(n+m) time. The
+ * arguments without attackers are labelled IN first. Whenever an argument is
+ * labelled OUT, the counters of undefeated attackers of the arguments it attacks
+ * are decreased and an argument is labelled IN once its counter drops to zero.
+ */
+label_t GroundedSolver::propagate(const AttackRelation &ar, arg_t query) {
+  using namespace labels;
+  const int n = ar.arg_cnt;
+  if (threads > 1 && n >= parallel_grain)
+    return propagate_parallel(ar, query);
+  labelling.assign(n, UNDEC);
+  derived.assign(n, 0);
+  clock = 0;
+  undefeated.resize(n);
+  /**
+   * IN arguments whose attacked arguments are yet to be labelled OUT
+   */
+  std::vector<arg_t> worklist;
+  for (int i = 0; i < n; i++)
+    undefeated[i] = ar.indegree(i);
+  for (int i = 0; i < n; i++) {
+    if (undefeated[i] == 0) {
+      labelling[i] = IN;
+      derived[i] = ++clock;
+      if (i == query)
+        return IN;
+      worklist.push_back(i);
     }
+  }
+  while (!worklist.empty()) {
+    const arg_t arg = worklist.back();
+    worklist.pop_back();
+    for (arg_t atted : ar.attacked_set(arg)) {
+      if (labelling[atted] == OUT)
+        continue;
+      labelling[atted] = OUT;
+      derived[atted] = ++clock;
+      if (atted == query)
+        return OUT;
+      for (arg_t next : ar.attacked_set(atted)) {
+        if (--undefeated[next] == 0 && labelling[next] == UNDEC) {
+          labelling[next] = IN;
+          derived[next] = ++clock;
+          if (next == query)
+            return IN;
+          worklist.push_back(next);
+        }
+      }
+    }
+  }
+  return UNDEC;
+}
+
+/**
+ * Level-synchronous version of propagate. Every round processes the current IN
+ * frontier, which is split among the threads: an argument attacked by the frontier
+ * is claimed by the thread which labels it OUT, which then decreases the counters
+ * of the arguments it attacks atomically. The thread whose decrement makes a
+ * counter drop to zero labels that argument IN and adds it to the next frontier.
+ * Derivation times are given per round, so an argument is still derived after the
+ * arguments it depends on.
+ */
+label_t GroundedSolver::propagate_parallel(const AttackRelation &ar, arg_t query) {
+  using namespace labels;
+  const int n = ar.arg_cnt;
+  std::atomic<label_t> *labels = new std::atomic<label_t> [n];
+  std::atomic<int> *counters = new std::atomic<int> [n];
+  derived.assign(n, 0);
+  std::vector<std::vector<arg_t>> next (threads);
 
-    bool change = true;
-    while (change) {
-      change = false;
-      for (int i = 0; i< ar.arg_cnt; i++) {
-        if (labels[i] == UNDEC) {
-          if (agressor_cnt[i] == 0) {
-            labels[i] = IN;
-            change = true;
-            for (int atted : ar.attacked_set(i)) {
-              if (labels[atted] != OUT) {
-                labels[atted] = OUT;
-                for (int attedatted : ar.attacked_set(atted)) {
-                  agressor_cnt[attedatted] --;
-                }
-              }
+  /**
+   * calls task with a thread index and a range of [0,size), small ranges are not
+   * split
+   */
+  auto parallel_for = [&](std::size_t size, std::function<void(int, std::size_t, std::size_t)> task) {
+    if (size < parallel_grain) {
+      task(0, 0, size);
+      return;
+    }
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; i++)
+      workers.emplace_back(task, i, size * i / threads, size * (i + 1) / threads);
+    for (auto &worker : workers)
+      worker.join();
+  };
+  auto gather = [&](std::vector<arg_t> &frontier) {
+    frontier.clear();
+    for (auto &part : next) {
+      frontier.insert(frontier.end(), part.begin(), part.end());
+      part.clear();
+    }
+  };
+
+  parallel_for(n, [&](int thread, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; i++) {
+      counters[i].store(ar.indegree(i), std::memory_order_relaxed);
+      labels[i].store(counters[i] ? UNDEC : IN, std::memory_order_relaxed);
+      if (!counters[i]) {
+        derived[i] = 1;
+        next[thread].push_back(i);
+      }
+    }
+  });
+  std::vector<arg_t> frontier;
+  gather(frontier);
+
+  int round = 0;
+  while (!frontier.empty() && (query < 0 || labels[query] == UNDEC)) {
+    round++;
+    parallel_for(frontier.size(), [&](int thread, std::size_t begin, std::size_t end) {
+      for (std::size_t i = begin; i < end; i++) {
+        for (arg_t atted : ar.attacked_set(frontier[i])) {
+          label_t expected = UNDEC;
+          if (!labels[atted].compare_exchange_strong(expected, OUT))
+            continue;
+          derived[atted] = 2 * round;
+          for (arg_t atted_atted : ar.attacked_set(atted)) {
+            if (counters[atted_atted].fetch_sub(1) == 1 && labels[atted_atted] == UNDEC) {
+              labels[atted_atted] = IN;
+              derived[atted_atted] = 2 * round + 1;
+              next[thread].push_back(atted_atted);
             }
           }
         }
       }
-    }
+    });
+    gather(frontier);
+  }
+
+  labelling.resize(n);
+  for (int i = 0; i < n; i++)
+    labelling[i] = labels[i];
+  clock = 2 * round + 1;
+  const label_t label = query < 0 || labelling[query] == UNDEC ? UNDEC : labelling[query];
+  delete[] labels;
+  delete[] counters;
+  return label;
+}
 
+/**
+ * Repairs the labelling after the attack relation was changed. A label which was
+ * derived before can only become invalid if it depends on a changed argument, so
+ * the changed arguments are reset first. Then the IN or OUT arguments attacked by
+ * reset arguments are checked in the order in which they were derived: an OUT
+ * argument which still has an IN attacker derived before it keeps its label, any
+ * other one is reset as well. Labels are finally derived again starting from the
+ * reset arguments, which may also decide arguments which were UNDEC.
+ */
+void GroundedSolver::repair(const AttackRelation &ar) {
+  using namespace labels;
+  const int n = ar.arg_cnt;
+  const std::vector<arg_t> &changes = ar.changed_args();
+  labelling.resize(n, UNDEC);
+  derived.resize(n);
+  undefeated.resize(n);
+  visited.resize(n, false);
 
-  std::vector<int> ext;
-  for (int i = 0; i<ar.arg_cnt; i++) {
-    if(labels[i] & IN)
-      ext.push_back(i);
+  std::vector<arg_t> reset, checked;
+  for (std::size_t i = synced; i < changes.size(); i++) {
+    if (changes[i] < n && !visited[changes[i]]) {
+      visited[changes[i]] = true;
+      labelling[changes[i]] = UNDEC;
+      reset.push_back(changes[i]);
+    }
+  }
+  /**
+   * arguments to be checked ordered by the time they were derived, so that the
+   * arguments an argument was derived from are settled when it is checked
+   */
+  std::priority_queue<std::pair<int,arg_t>, std::vector<std::pair<int,arg_t>>,
+    std::greater<std::pair<int,arg_t>>> candidates;
+  auto expand = [&](arg_t arg) {
+    for (arg_t atted : ar.attacked_set(arg)) {
+      if (!visited[atted] && labelling[atted] != UNDEC) {
+        visited[atted] = true;
+        candidates.push(std::make_pair(derived[atted], atted));
+      }
+    }
+  };
+  for (std::size_t i = 0; i < reset.size(); i++)
+    expand(reset[i]);
+  while (!candidates.empty()) {
+    const arg_t arg = candidates.top().second;
+    candidates.pop();
+    bool supported = false;
+    if (labelling[arg] == OUT) {
+      for (arg_t atter : ar.attacker_set(arg)) {
+        if (labelling[atter] == IN && derived[atter] < derived[arg]) {
+          supported = true;
+          break;
+        }
+      }
+    }
+    if (supported) {
+      checked.push_back(arg);
+    } else {
+      labelling[arg] = UNDEC;
+      reset.push_back(arg);
+      expand(arg);
+    }
   }
 
-  delete[] agressor_cnt;
+  /**
+   * the number of attackers which are not OUT is counted once an argument is
+   * visited, afterwards it is decreased whenever one of them is labelled OUT
+   */
+  auto count_undefeated = [&](arg_t arg) {
+    int cnt = 0;
+    for (arg_t atter : ar.attacker_set(arg))
+      if (labelling[atter] != OUT)
+        cnt++;
+    return cnt;
+  };
+  /**
+   * IN arguments whose attacked arguments are yet to be labelled OUT
+   */
+  std::vector<arg_t> pending, touched;
+  auto label_out = [&](arg_t arg) {
+    labelling[arg] = OUT;
+    derived[arg] = ++clock;
+    for (arg_t atted : ar.attacked_set(arg)) {
+      if (labelling[atted] != UNDEC)
+        continue;
+      if (!visited[atted]) {
+        visited[atted] = true;
+        touched.push_back(atted);
+        undefeated[atted] = count_undefeated(atted);
+      } else {
+        undefeated[atted]--;
+      }
+      if (undefeated[atted] == 0) {
+        labelling[atted] = IN;
+        derived[atted] = ++clock;
+        pending.push_back(atted);
+      }
+    }
+  };
+  for (arg_t arg : reset)
+    undefeated[arg] = count_undefeated(arg);
+  for (arg_t arg : reset) {
+    if (labelling[arg] != UNDEC)
+      continue;
+    if (undefeated[arg] == 0) {
+      labelling[arg] = IN;
+      derived[arg] = ++clock;
+      pending.push_back(arg);
+      continue;
+    }
+    for (arg_t atter : ar.attacker_set(arg)) {
+      if (labelling[atter] == IN) {
+        label_out(arg);
+        break;
+      }
+    }
+  }
+  while (!pending.empty()) {
+    const arg_t arg = pending.back();
+    pending.pop_back();
+    for (arg_t atted : ar.attacked_set(arg))
+      if (labelling[atted] != OUT)
+        label_out(atted);
+  }
 
-  return ext;
+  for (arg_t arg : reset)
+    visited[arg] = false;
+  for (arg_t arg : checked)
+    visited[arg] = false;
+  for (arg_t arg : touched)
+    visited[arg] = false;
+  synced = changes.size();
 }
 
 // Algorithm to find the grounded extension according to Nofal, Atkinson and Dunne (2014)
 // adjusted for justification
 bool GroundedSolver::justify (const AttackRelation &ar, arg_t arg, bool sceptical) {
   using namespace labels;
-  std::vector<label_t> labels (ar.arg_cnt, UNDEC);
-  while (true) {
-    bool change = false;
-    for (int i = 0; i< ar.arg_cnt; i++) {
-      if (labels[i] == UNDEC) {
-        bool set_in = true;
-        for (int atter : ar.attacker_set(i)) {
-          if (labels[atter] != OUT) {
-            set_in = false;
-            break;
-          }
-        }
-        if (set_in) {
-          if (i == arg) {
-            return true;
-          }
-          change = true;
-          labels[i] = IN;
-          for (int atted : ar.attacked_set(i)) {
-            if (atted == arg) {
-              return false;
-            }
-            labels[atted] = OUT;
-          }
-        }
-      }
-    }
-    if (!change)
-      return false;
+  if (ar.analysis.has_grounded)
+    return std::binary_search(ar.analysis.grounded.begin(), ar.analysis.grounded.end(), arg);
+  if (tracked == &ar) {
+    sync(ar);
+    return labelling[arg] == IN;
+  }
+  /**
+   * the labelling is only kept if the query did not end the propagation early
+   */
+  tracked = nullptr;
+  const label_t label = propagate(ar, arg);
+  if (label == UNDEC) {
+    tracked = &ar;
+    synced = ar.changed_args().size();
   }
+  return label == IN;
 }
@@ -0,0 +1,96 @@
+#include "solver.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+namespace {
+  /**
+   * the interval in which a race checks whether it was cancelled from outside
+   */
+  constexpr int poll_ms = 10;
+
+  /**
+   * Runs a task once per solver on its own thread and returns the result of the
+   * first one to finish. The others are cancelled and their results are discarded.
+   * The calling thread waits meanwhile and polls the outer flag, if it is set all
+   * solvers are cancelled and the result is meaningless.
+   * @param  solvers   the solvers
+   * @param  cancelled the flag by which the race itself is cancelled and which the
+   *                   solvers are cancelled with afterwards, or null
+   * @param  result    the result if the race is cancelled from outside
+   * @param  task      the task, which is given a solver
+   * @return           the result of the winner
+   */
+  template<typename result_t, typename task_t>
+  result_t race(const std::vector<Solver*> &solvers, const std::atomic<bool> *cancelled, result_t result,
+      task_t task) {
+    std::atomic<bool> decided {false};
+    std::mutex mutex;
+    std::condition_variable finished;
+    int running = solvers.size();
+    auto run = [&](Solver *solver) {
+      solver->cancel_with(&decided);
+      result_t own = task(*solver);
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!decided) {
+        result = std::move(own);
+        decided = true;
+      }
+      running--;
+      finished.notify_one();
+    };
+    std::vector<std::thread> threads;
+    for (Solver *solver : solvers)
+      threads.emplace_back(run, solver);
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (running > 0) {
+        if (cancelled && *cancelled)
+          decided = true;
+        finished.wait_for(lock, std::chrono::milliseconds(poll_ms));
+      }
+    }
+    for (auto &thread : threads)
+      thread.join();
+    for (Solver *solver : solvers)
+      solver->cancel_with(cancelled);
+    return result;
+  }
+}
+
+PortfolioSolver::~PortfolioSolver() {
+  for (Solver *solver : solvers)
+    delete solver;
+}
+
+ExtensionStore PortfolioSolver::enum_exts(const AttackRelation &ar, int max_cnt) {
+  if (max_cnt != 1 || solvers.size() == 1) {
+    solvers[0]->cancel_with(cancelled);
+    return solvers[0]->enum_exts(ar, max_cnt);
+  }
+  return race(solvers, cancelled, ExtensionStore(ar.arg_cnt), [&](Solver &solver) {
+    return solver.enum_exts(ar, 1);
+  });
+}
+
+std::uint64_t PortfolioSolver::count_exts(const AttackRelation &ar) {
+  solvers[0]->cancel_with(cancelled);
+  return solvers[0]->count_exts(ar);
+}
+
+void PortfolioSolver::report_exts(const AttackRelation &ar, ExtensionCollector &results) {
+  solvers[0]->cancel_with(cancelled);
+  solvers[0]->report_exts(ar, results);
+}
+
+bool PortfolioSolver::justify(const AttackRelation &ar, arg_t arg, bool sceptical) {
+  if (solvers.size() == 1) {
+    solvers[0]->cancel_with(cancelled);
+    return solvers[0]->justify(ar, arg, sceptical);
+  }
+  return race(solvers, cancelled, false, [&](Solver &solver) {
+    return solver.justify(ar, arg, sceptical);
+  });
+}
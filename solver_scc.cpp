@@ -0,0 +1,352 @@
+#include "solver.h"
+#include "collector.h"
+#include "extension_store.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
+namespace {
+  using namespace labels;
+
+  /**
+   * How an argument of an SCC is affected by the labels of its attackers from
+   * preceding SCCs
+   */
+  namespace external {
+    constexpr char
+      FREE = 0,
+      /**
+       * attacked by an IN argument, so the argument is OUT
+       */
+      DEFEATED = 1,
+      /**
+       * attacked by an undecided argument only, so the argument cannot be IN
+       */
+      UNDECIDED = 2;
+  }
+
+  /**
+   * Enumerates labellings SCC by SCC. A labelling of an SCC is a extension of the
+   * AAF restricted to those of its arguments which are not defeated from outside.
+   * For complete and preferred semantics, arguments which are attacked by undecided
+   * arguments from outside are additionally attacked by a self-attacking argument,
+   * which is undecided as well.
+   */
+  class SCCRecursion {
+    const AttackRelation &ar;
+    const int n;
+    const SCCSolver::semantics_t semantics;
+    const int threads;
+    /**
+     * the number of extensions needed per SCC, 0 if all are needed
+     */
+    const int needed;
+    const std::atomic<bool> *cancelled;
+    /**
+     * the arguments of every SCC in the order of the heuristic, the SCCs are
+     * topologically sorted
+     */
+    std::vector<std::vector<arg_t>> members;
+    std::vector<int> component;
+    /**
+     * the position of every argument among the members of its SCC
+     */
+    std::vector<int> position;
+    /**
+     * the arguments of every SCC which are attacked from outside of it
+     */
+    std::vector<std::vector<arg_t>> boundary;
+    /**
+     * the extensions of every SCC found so far, as positions among the members of
+     * the SCC
+     */
+    std::vector<ExtensionStore> exts;
+    /**
+     * the range of the extensions of every SCC by the external state of its boundary
+     */
+    std::vector<std::unordered_map<std::string, std::pair<int, int>>> solved;
+    std::vector<char> state;
+    std::vector<int> local;
+    labelling_t labels;
+    /**
+     * the IN arguments SCC by SCC in the order of the search
+     */
+    std::vector<arg_t> in_args;
+    /**
+     * scratch space for an extension of an SCC
+     */
+    std::vector<int> ext;
+
+    /**
+     * Enumerates the extensions of an SCC under the current labels of the preceding
+     * SCCs
+     * @param  k the SCC
+     * @return   the range of its extensions in exts[k]
+     */
+    std::pair<int, int> solve(int k) {
+      std::string key;
+      key.reserve(boundary[k].size());
+      bool undecided = false;
+      for (arg_t arg : boundary[k]) {
+        state[arg] = external::FREE;
+        for (arg_t atter : ar.attacker_set(arg)) {
+          if (component[atter] == k)
+            continue;
+          if (labels[atter] == IN) {
+            state[arg] = external::DEFEATED;
+            break;
+          }
+          if (labels[atter] == UNDEC)
+            state[arg] = external::UNDECIDED;
+        }
+        undecided |= state[arg] == external::UNDECIDED;
+        key.push_back(state[arg]);
+      }
+      auto found = solved[k].find(key);
+      if (found != solved[k].end())
+        return found->second;
+      const int first = exts[k].size();
+      append(k, undecided);
+      return solved[k][key] = std::make_pair(first, int(exts[k].size()));
+    }
+
+    /**
+     * Appends the extensions of an SCC to exts[k], the external state of its
+     * boundary has to be set
+     * @param k         the SCC
+     * @param undecided whether an argument of the SCC is attacked by an undecided one
+     */
+    void append(int k, bool undecided) {
+      std::vector<arg_t> kept;
+      for (arg_t arg : members[k])
+        if (state[arg] != external::DEFEATED) {
+          local[arg] = kept.size();
+          kept.push_back(arg);
+        }
+      std::vector<Attack> atts;
+      for (arg_t arg : kept)
+        for (arg_t atted : ar.attacked_set(arg))
+          if (component[atted] == k && state[atted] != external::DEFEATED)
+            atts.push_back(Attack {local[arg], local[atted]});
+      if (kept.empty()) {
+        exts[k].push_back(std::vector<int> ());
+        return;
+      }
+      /**
+       * a single argument without attacks needs no search
+       */
+      if (kept.size() == 1 && atts.empty()) {
+        ext.clear();
+        if (state[kept[0]] != external::UNDECIDED)
+          ext.push_back(position[kept[0]]);
+        exts[k].push_back(ext);
+        return;
+      }
+      int sub_cnt = kept.size();
+      if (undecided && semantics != SCCSolver::STABLE) {
+        const arg_t gadget = sub_cnt++;
+        atts.push_back(Attack {gadget, gadget});
+        for (arg_t arg : kept)
+          if (state[arg] == external::UNDECIDED)
+            atts.push_back(Attack {gadget, local[arg]});
+      }
+
+      AttackRelation sub (sub_cnt, atts);
+      if (ar.has_bitsets())
+        sub.build_bitsets();
+      /**
+       * the arguments are numbered in the order of the heuristic
+       */
+      ConstHeuristic order (0, sub_cnt);
+      Solver *solver;
+      if (semantics == SCCSolver::STABLE)
+        solver = new StableSolver(order, threads);
+      else if (semantics == SCCSolver::COMPLETE)
+        solver = new CompleteSolver(order);
+      else
+        solver = new PreferredSolver(order);
+      solver->cancel_with(cancelled);
+      const ExtensionStore sub_exts = solver->enum_exts(sub, needed);
+      delete solver;
+      for (auto &sub_ext : sub_exts) {
+        ext.clear();
+        for (arg_t arg : sub_ext)
+          ext.push_back(position[kept[arg]]);
+        exts[k].push_back(ext);
+      }
+    }
+
+    /**
+     * Labels the arguments of an SCC according to one of its extensions and appends
+     * its IN arguments to in_args
+     * @param k the SCC
+     * @param i the position of the extension in exts[k]
+     */
+    void apply(int k, int i) {
+      const std::vector<arg_t> &scc = members[k];
+      for (arg_t arg : scc)
+        labels[arg] = UNDEC;
+      exts[k].for_each(i, [&](int pos) {
+        labels[scc[pos]] = IN;
+        in_args.push_back(scc[pos]);
+      });
+      for (arg_t arg : members[k]) {
+        if (labels[arg] == IN)
+          continue;
+        for (arg_t atter : ar.attacker_set(arg))
+          if (labels[atter] == IN) {
+            labels[arg] = OUT;
+            break;
+          }
+      }
+    }
+
+  public:
+    /**
+     * @param ar        the attack relation
+     * @param semantics the semantics
+     * @param heuristic a static heuristic
+     * @param threads   the number of threads per stable search
+     * @param needed    the number of extensions needed per SCC, 0 if all are needed
+     * @param cancelled a flag which cancels the searches of the SCCs, or null
+     */
+    SCCRecursion(const AttackRelation &ar, SCCSolver::semantics_t semantics,
+        Heuristic &heuristic, int threads, int needed, const std::atomic<bool> *cancelled)
+        : ar(ar), n(ar.arg_cnt), semantics(semantics), threads(threads), needed(needed),
+          cancelled(cancelled),
+          component(n), position(n), state(n, external::FREE), local(n), labels(n, BLANK) {
+      const std::vector<int> sccs = ar.analysis.sccs.size() == n ? ar.analysis.sccs : compute_sccs(ar);
+      /**
+       * Tarjan's algorithm numbers an SCC after all SCCs it attacks
+       */
+      const int scc_cnt = n ? *std::max_element(sccs.begin(), sccs.end()) + 1 : 0;
+      members.resize(scc_cnt);
+      boundary.resize(scc_cnt);
+      solved.resize(scc_cnt);
+      for (auto &p : heuristic.get_order()) {
+        component[p.first] = scc_cnt - 1 - sccs[p.first];
+        position[p.first] = members[component[p.first]].size();
+        members[component[p.first]].push_back(p.first);
+      }
+      for (auto &scc : members)
+        exts.emplace_back(scc.size());
+      for (arg_t arg = 0; arg < n; arg++)
+        for (arg_t atter : ar.attacker_set(arg))
+          if (component[atter] != component[arg]) {
+            boundary[component[arg]].push_back(arg);
+            break;
+          }
+    }
+
+    /**
+     * Enumerates the extensions by backtracking over the extensions of the SCCs
+     * @param results the collector to which extensions are reported
+     * @param query   an argument or -1, only labellings in which its label agrees
+     *                with accepted are reported
+     * @param accepted whether the query has to be IN
+     */
+    void search(ExtensionCollector &results, arg_t query = -1, bool accepted = true) {
+      /**
+       * complete and preferred labellings of the preceding SCCs can always be
+       * completed, so only the SCCs which reach the query are needed
+       */
+      std::vector<int> sequence;
+      if (query >= 0 && semantics != SCCSolver::STABLE) {
+        std::vector<bool> reaches (members.size(), false);
+        std::vector<int> pending {component[query]};
+        reaches[component[query]] = true;
+        while (!pending.empty()) {
+          const int k = pending.back();
+          pending.pop_back();
+          for (arg_t arg : boundary[k])
+            for (arg_t atter : ar.attacker_set(arg))
+              if (!reaches[component[atter]]) {
+                reaches[component[atter]] = true;
+                pending.push_back(component[atter]);
+              }
+        }
+        for (int k = 0; k < members.size(); k++)
+          if (reaches[k])
+            sequence.push_back(k);
+      } else {
+        for (int k = 0; k < members.size(); k++)
+          sequence.push_back(k);
+      }
+
+      const int depth = sequence.size();
+      /**
+       * for every level the extension of its SCC which is applied, the end of its
+       * extensions and the number of IN arguments of the preceding levels
+       */
+      std::vector<int> choice (depth), end (depth), in_cnt (depth);
+      int level = 0;
+      bool descend = true;
+      while (level >= 0 && !results.is_stopped()) {
+        if (descend) {
+          if (level == depth) {
+            results.report_ext_labelling(labels, in_args);
+            level--;
+            descend = false;
+            continue;
+          }
+          const std::pair<int, int> range = solve(sequence[level]);
+          choice[level] = range.first;
+          end[level] = range.second;
+          in_cnt[level] = in_args.size();
+        } else {
+          choice[level]++;
+        }
+        const int k = sequence[level];
+        if (choice[level] < end[level]) {
+          in_args.resize(in_cnt[level]);
+          apply(k, choice[level]);
+          if (query >= 0 && component[query] == k && (labels[query] == IN) != accepted) {
+            descend = false;
+          } else {
+            level++;
+            descend = true;
+          }
+        } else {
+          level--;
+          descend = false;
+        }
+      }
+    }
+  };
+
+}
+
+ExtensionStore SCCSolver::enum_exts(const AttackRelation &ar, int max_cnt) {
+  ExtensionEnumerator results {ar.arg_cnt, max_cnt};
+  results.cancel_with(cancelled);
+  /**
+   * every complete or preferred extension of an SCC can be completed, so a single
+   * one per SCC yields a single extension
+   */
+  const int needed = max_cnt == 1 && semantics != STABLE ? 1 : 0;
+  SCCRecursion {ar, semantics, heuristic, threads, needed, cancelled}.search(results);
+  return results.exts;
+}
+
+std::uint64_t SCCSolver::count_exts(const AttackRelation &ar) {
+  ExtensionCounter results;
+  results.cancel_with(cancelled);
+  SCCRecursion {ar, semantics, heuristic, threads, 0, cancelled}.search(results);
+  return results.count;
+}
+
+void SCCSolver::report_exts(const AttackRelation &ar, ExtensionCollector &results) {
+  SCCRecursion {ar, semantics, heuristic, threads, 0, cancelled}.search(results);
+}
+
+bool SCCSolver::justify(const AttackRelation &ar, arg_t arg, bool sceptical) {
+  ArgumentJustifier results {arg, sceptical};
+  results.cancel_with(cancelled);
+  /**
+   * For sceptical justification only labellings in which the argument is not IN
+   * are relevant and for credulous justification only those in which it is
+   */
+  SCCRecursion {ar, semantics, heuristic, threads, 0, cancelled}.search(results, arg, !sceptical);
+  return results.is_justified();
+}
@@ -1,16 +1,115 @@
 #include "solver.h"
 #include "collector.h"
+#include "bitset.h"
+#include "trail.h"
 
 #include <iostream>
-#include <stack>
+#include <queue>
+#include <climits>
+#include <algorithm>
+#include <deque>
+#include <thread>
+#include <condition_variable>
 
 namespace {
 
   using namespace labels;
 
   /**
-   * An algorithm to enumerate stable extensions
+   * A label of an argument as used by nogoods, 2*arg+1 stands for arg being IN and
+   * 2*arg for arg being OUT
    */
+  typedef int lit_t;
+
+  inline lit_t literal(arg_t arg, label_t label) {return 2 * arg + (label == IN);}
+
+  /**
+   * Reasons for labels which are not implied by other labels, any reason below
+   * refers to the nogood -reason-2
+   */
+  constexpr int DECIDED = -1;
+
+  /**
+   * Limits on learned nogoods. Longer nogoods hardly ever propagate, they are only
+   * kept as reasons for the labels they imply.
+   */
+  constexpr std::size_t max_watched_size = 24, max_nogood_lits = 1 << 24;
+
+  /**
+   * An open subtree of the search, given by the labels which lead to it. Unless the
+   * subtree is prepared, the grounded extension and the exclusion of self-attacking
+   * arguments still have to be added.
+   */
+  struct Subtree {
+    std::vector<lit_t> path;
+    bool prepared;
+  };
+
+  /**
+   * The open subtrees shared by the threads of a parallel enumeration. Threads which
+   * run out of work wait for busy threads to give away parts of their subtrees. The
+   * enumeration ends once all threads wait or the collector is stopped.
+   */
+  class WorkPool {
+    const int threads;
+    ExtensionCollector &results;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<Subtree> open;
+    int idle = 0;
+    bool finished = false;
+
+    inline void update() {wanted = idle - (int)open.size();}
+  public:
+    /**
+     * the number of waiting threads which no open subtree is left for, busy threads
+     * check it before every decision
+     */
+    std::atomic<int> wanted {0};
+
+    WorkPool(int threads, ExtensionCollector &results) : threads(threads), results(results) {}
+
+    void give(Subtree subtree) {
+      std::lock_guard<std::mutex> lock(mutex);
+      open.push_back(std::move(subtree));
+      update();
+      changed.notify_one();
+    }
+
+    /**
+     * Waits for an open subtree
+     * @return false iff the enumeration has ended
+     */
+    bool take(Subtree &subtree) {
+      std::unique_lock<std::mutex> lock(mutex);
+      idle++;
+      update();
+      while (open.empty() && !finished) {
+        if (idle == threads || results.is_stopped()) {
+          finished = true;
+          changed.notify_all();
+        } else {
+          changed.wait(lock);
+        }
+      }
+      if (finished || results.is_stopped()) {
+        finished = true;
+        changed.notify_all();
+        return false;
+      }
+      subtree = std::move(open.front());
+      open.pop_front();
+      idle--;
+      update();
+      return true;
+    }
+  };
+
+  /**
+   * An algorithm to enumerate stable extensions. It is templated on the type of the
+   * collector, so reports to a final collector class are bound at compile time.
+   */
+  template <class Collector>
   class StableEnumerator : HeuristicAlgorithm {
 
     /**
@@ -22,30 +121,123 @@ namespace {
      */
     const int n;
     /**
-     * Stacks which keep track of all taken decision sin case they have to be reverted
+     * The labels taken so far, in case they have to be reverted
+     */
+    Trail trail;
+    /**
+     * If the attack relation provides bitsets, the arguments attacked by IN
+     * labelled arguments are kept as a bitset as well. Candidates for propagation
+     * are then found word-parallel and the aggressor counters are not maintained.
+     */
+    const bool dense;
+    std::vector<bits::word_t> range_bits;
+    /**
+     * The number of arguments which are either both or neither IN and attacked by
+     * an IN argument, the IN arguments are stable iff there is none, and its value
+     * before every position of the trail
+     */
+    int mismatched;
+    std::vector<int> mismatched_at;
+    /**
+     * The memory of pos_range, neg_range and agressor_cnt in this order, changes
+     * of these counters are logged on the trail by their position in it. Changes of
+     * pos_range which make an argument attacked are flagged in the dense case.
+     */
+    int *counters;
+    /**
+     * candidates for propagation, set_in appends a bitset for each nested call
+     */
+    std::vector<bits::word_t> candidates;
+    /**
+     * For every labelled argument, the decision level and the position on the trail
+     * at which it was labelled and the reason for its label. The
+     * reason of an implied label is an argument: an IN argument adjacent to an OUT
+     * argument, or the argument whose attackers could not be IN except for the one
+     * which was labelled IN.
+     */
+    std::vector<int> level_of, trail_pos, reason;
+    /**
+     * Levels up to this one have led to extensions, their flipped decisions must not
+     * be skipped by backjumping as they prevent reporting extensions twice
+     */
+    int floor = 0;
+    /**
+     * Learned nogoods, i.e. sets of labels which do not occur together in any stable
+     * extension. Every nogood watches its first two labels, which are not both set
+     * unless the nogood is violated or the other one has been reverted.
+     */
+    std::vector<std::vector<lit_t>> nogoods;
+    std::vector<std::vector<int>> watches;
+    std::size_t nogood_lits = 0;
+    /**
+     * the labels which caused the last conflict, empty if the last propagation
+     * ended with an extension
+     */
+    std::vector<lit_t> conflict;
+    std::vector<bool> seen;
+    /**
+     * whether labels are implied by a nogood being minimized
+     */
+    enum {UNKNOWN, REDUNDANT, NEEDED};
+    std::vector<char> state;
+    std::vector<arg_t> touched;
+    /**
+     * In a parallel enumeration, the pool to which open subtrees are given away.
+     * The decisions up to donated_level have been given away with their flipped
+     * labels, so they are neither flipped nor skipped by backjumping.
+     */
+    WorkPool *pool = nullptr;
+    int donated_level = 0;
+
+    inline bool holds(lit_t lit) const {return labels[lit >> 1] == (lit & 1 ? IN : OUT);}
+    inline bool contradicted(lit_t lit) const {return labels[lit >> 1] == (lit & 1 ? OUT : IN);}
+
+    /**
+     * Pushes a label onto the trail
      */
-    std::stack<int> decisions_index, decisions_arg;
+    inline void record(arg_t arg, int index, int why) {
+      trail_pos[arg] = trail.size();
+      mismatched_at[trail.size()] = mismatched;
+      trail.push(arg, index, labels[arg] == IN);
+      level_of[arg] = trail.level();
+      reason[arg] = why;
+    }
 
   public:
     /**
      * Creates a new Stable Algorithm
-     * @param ar the underlying AAF as an attack relation
+     * @param ar      the underlying AAF as an attack relation
+     * @param dynamic whether the heuristic is dynamic, dynamic heuristics read the
+     *                aggressor counters, so the bitsets are not used then
+     * @param pool    the pool to which open subtrees are given away in a parallel
+     *                enumeration
      */
-    StableEnumerator(const AttackRelation &ar)
-        : ar(ar), n(ar.arg_cnt) {
+    StableEnumerator(const AttackRelation &ar, bool dynamic = false, WorkPool *pool = nullptr)
+        : ar(ar), n(ar.arg_cnt), trail(ar.arg_cnt, 3 * ar.attack_cnt() + 1), dense(ar.has_bitsets() && !dynamic),
+          mismatched(ar.arg_cnt), pool(pool) {
       labels = labelling_t(n, BLANK);
-      pos_range = new int [n]();
-      neg_range = new int [n]();
-      agressor_cnt = new int [n];
-      for (int i = 0; i < n ; i++) {
-        agressor_cnt[i] = ar.indegree(i);
+      level_of.resize(n);
+      trail_pos.resize(n);
+      reason.resize(n);
+      mismatched_at.resize(n);
+      seen.resize(n);
+      state.resize(n, UNKNOWN);
+      counters = new int [3 * n]();
+      pos_range = counters;
+      neg_range = counters + n;
+      if (dense) {
+        agressor_cnt = nullptr;
+        range_bits.assign(ar.bitset_words(), 0);
+      } else {
+        agressor_cnt = counters + 2 * n;
+        for (int i = 0; i < n ; i++) {
+          agressor_cnt[i] = ar.indegree(i);
+        }
       }
     }
 
     ~StableEnumerator() {
-      delete[] pos_range;
-      delete[] neg_range;
-      delete[] agressor_cnt;
+      delete[] counters;
     }
 
     /**
@@ -55,42 +247,71 @@ namespace {
      * @param  results result builder to which found extensions are reported
      * @return         false if a stable extension was reached or conflicts occured
      */
-    bool set_in (arg_t arg, int index, ExtensionCollector &results) {
+    bool set_in (arg_t arg, int index, Collector &results, int why = DECIDED) {
       labels[arg] = IN;
-      decisions_index.push(index);
-      decisions_arg.push(arg);
+      record(arg, index, why);
+      mismatched += pos_range[arg] == 0 ? -1 : 1;
       for (arg_t a : ar.attacker_set(arg)) {
         neg_range[a] ++;
+        trail.log(n + a);
       }
-      for (arg_t atted : ar.attacked_set(arg)) {
-        pos_range[atted] ++;
-        if (pos_range[atted] == 1)
-          for (arg_t attedatted : ar.attacked_set(atted)) {
-            agressor_cnt[attedatted]--;
+      const std::size_t logged = trail.logged();
+      if (dense) {
+        for (arg_t atted : ar.attacked_set(arg)) {
+          const bool attacked = pos_range[atted]++ == 0;
+          trail.log(atted, attacked);
+          if (attacked) {
+            bits::insert(range_bits.data(), atted);
+            mismatched += labels[atted] == IN ? 1 : -1;
           }
+        }
+      } else {
+        for (arg_t atted : ar.attacked_set(arg)) {
+          pos_range[atted] ++;
+          trail.log(atted);
+          if (pos_range[atted] == 1) {
+            mismatched += labels[atted] == IN ? 1 : -1;
+            for (arg_t attedatted : ar.attacked_set(atted)) {
+              agressor_cnt[attedatted]--;
+              trail.log(2 * n + attedatted, agressor_cnt[attedatted] == 0);
+            }
+          }
+        }
       }
+      const std::size_t end = trail.logged();
 
       for (arg_t atter : ar.attacker_set(arg)) {
-        if(!set_out(atter, results))
+        if(!set_out(atter, results, indices::BACKTRACK, arg))
           return false;
       }
       for (arg_t atted : ar.attacked_set(arg)) {
-        set_out(atted, results);
+        if(!set_out(atted, results, indices::BACKTRACK, arg))
+          return false;
       }
-      for (arg_t atted : ar.attacked_set(arg)) {
-          if (pos_range[atted] == 1)
-            for (arg_t attedatted : ar.attacked_set(atted)) {
-             if (labels[attedatted] != IN && agressor_cnt[attedatted] == 0) {
-                if (labels[attedatted] == OUT)
-                  return false;
-                if (labels[attedatted] == BLANK)
-                  if (!set_in(attedatted, indices::BACKTRACK, results))
-                    return false;
-              }
-            }
+      if (dense) {
+        if (!propagate_dense(arg, results))
+          return false;
+      } else {
+        // the arguments whose attackers have just all become attacked are flagged
+        // in the log
+        for (std::size_t i = logged; i < end; i++) {
+          const Trail::change_t change = trail.change(i);
+          if (change & 1) {
+            const arg_t attedatted = (change >> 1) - 2 * n;
+            if (labels[attedatted] == OUT)
+              return fail_unattacked(attedatted);
+            if (labels[attedatted] == BLANK)
+              if (!set_in(attedatted, indices::BACKTRACK, results, attedatted))
+                return false;
+          }
+        }
       }
+      if (!propagate_nogoods(literal(arg, IN), results))
+        return false;
       if (is_stable())  {
-        results.report_ext_labelling(labels);
+        conflict.clear();
+        floor = trail.level();
+        results.report_ext_labelling(labels, trail.in_args());
         return false;
       }
       return true;
@@ -101,13 +322,23 @@ namespace {
      * @param  arg     the argument whose label is to be changes
      * @param  index   the algorithm step counter
      * @param  results result builder to which found extensions are reported
+     * @param  why     the IN argument which attacks or is attacked by arg
      * @return         false if a stable extension was reached or conflicts occured
      */
-    bool set_out (arg_t arg, ExtensionCollector &results, int index = indices::BACKTRACK) {
+    bool set_out (arg_t arg, Collector &results, int index = indices::BACKTRACK, int why = DECIDED) {
+      /**
+       * a nogood may set an argument IN next to an IN argument before the latter has
+       * excluded its neighbours
+       */
+      if (labels[arg] == IN && why >= 0) {
+        conflict = {literal(arg, IN), literal(why, IN)};
+        return false;
+      }
       if (labels[arg] & BLANK) {
         labels[arg] = labels::OUT;
-        decisions_index.push(index);
-        decisions_arg.push(arg);
+        record(arg, index, why);
+        if (!propagate_nogoods(literal(arg, OUT), results))
+          return false;
       }
       if ( pos_range[arg] != 0 )
         return true;
@@ -124,39 +355,367 @@ namespace {
         }
       }
       if (candidate_cnt == 0) {
-        return false;
+        return fail_unattacked(arg);
       }
       if (candidate_cnt == 1) {
-        return set_in(candidate, indices::BACKTRACK, results);
+        return set_in(candidate, indices::BACKTRACK, results, arg);
       }
       return true;
     }
 
-    inline bool is_stable() {
-      for (int i = 0; i< n; i++)  {
-        if (labels[i] & IN) {
-    //      if (pos_range[i] > 0 || neg_range[i] > 0)
-      //      return false;
-          if (agressor_cnt[i] > 0)
-            return false;
+    /**
+     * Collects labels which prevent the attackers of an argument from being IN
+     * @param arg    the argument
+     * @param except an attacker which is skipped
+     * @param before only labels set before this position on the decision stacks
+     *               are used
+     * @param lits   the labels are appended to it
+     */
+    void explain_unattacked(arg_t arg, arg_t except, int before, std::vector<lit_t> &lits) {
+      auto witness = [&](ArgRange range) {
+        for (arg_t other : range) {
+          if (labels[other] == IN && trail_pos[other] < before) {
+            lits.push_back(literal(other, IN));
+            return true;
+          }
+        }
+        return false;
+      };
+      for (arg_t atter : ar.attacker_set(arg)) {
+        if (atter == except)
+          continue;
+        if (labels[atter] == OUT && trail_pos[atter] < before)
+          lits.push_back(literal(atter, OUT));
+        else if (!witness(ar.attacker_set(atter)))
+          witness(ar.attacked_set(atter));
+      }
+    }
+
+    /**
+     * Records a conflict since arg is OUT but none of its attackers can be IN
+     * @return false
+     */
+    bool fail_unattacked(arg_t arg) {
+      conflict.assign(1, literal(arg, OUT));
+      explain_unattacked(arg, -1, INT_MAX, conflict);
+      return false;
+    }
+
+    /**
+     * Collects the labels which implied the label of an argument
+     */
+    void explain(arg_t arg, std::vector<lit_t> &lits) {
+      const int why = reason[arg];
+      if (why < DECIDED) {
+        for (lit_t lit : nogoods[-why - 2])
+          if (lit >> 1 != arg)
+            lits.push_back(lit);
+      } else if (labels[arg] == OUT) {
+        lits.push_back(literal(why, IN));
+      } else {
+        if (why != arg)
+          lits.push_back(literal(why, OUT));
+        explain_unattacked(why, arg, trail_pos[arg], lits);
+      }
+    }
+
+    /**
+     * Visits the nogoods watching a label which has just been set. A nogood whose
+     * labels are all set but one implies the opposite of the remaining label.
+     * @param  lit     the label
+     * @param  results result builder to which found extensions are reported
+     * @return         false if a stable extension was reached or conflicts occured
+     */
+    bool propagate_nogoods(lit_t lit, Collector &results) {
+      if (watches.empty())
+        return true;
+      std::vector<int> &watching = watches[lit];
+      for (std::size_t i = 0; i < watching.size();) {
+        const int id = watching[i];
+        std::vector<lit_t> &nogood = nogoods[id];
+        if (nogood.size() == 1) {
+          conflict = nogood;
+          return false;
+        }
+        if (nogood[0] == lit)
+          std::swap(nogood[0], nogood[1]);
+        if (contradicted(nogood[0])) {
+          i++;
+          continue;
+        }
+        std::size_t other = 2;
+        while (other < nogood.size() && holds(nogood[other]))
+          other++;
+        if (other < nogood.size()) {
+          std::swap(nogood[1], nogood[other]);
+          watches[nogood[1]].push_back(id);
+          watching[i] = watching.back();
+          watching.pop_back();
           continue;
-        } else if (pos_range[i] == 0)// || agressor_cnt[i] == 0)
-          	return false;
+        }
+        if (holds(nogood[0])) {
+          conflict = nogood;
+          return false;
+        }
+        i++;
+        const arg_t arg = nogood[0] >> 1;
+        if (nogood[0] & 1 ? !set_out(arg, results, indices::BACKTRACK, -id - 2)
+            : !set_in(arg, indices::BACKTRACK, results, -id - 2))
+          return false;
       }
       return true;
     }
 
+    /**
+     * Checks whether a label of a nogood is implied by its other labels
+     * @param  arg   the argument
+     * @param  depth the remaining depth of the search for implying labels
+     * @return       true iff the label can be removed from the nogood
+     */
+    bool redundant(arg_t arg, int depth) {
+      if (reason[arg] == DECIDED || depth == 0)
+        return false;
+      std::vector<lit_t> implying;
+      explain(arg, implying);
+      for (lit_t lit : implying) {
+        const arg_t other = lit >> 1;
+        if (seen[other] || level_of[other] == 0 || state[other] == REDUNDANT)
+          continue;
+        if (state[other] == NEEDED || !redundant(other, depth - 1)) {
+          state[other] = NEEDED;
+          touched.push_back(other);
+          return false;
+        }
+        state[other] = REDUNDANT;
+        touched.push_back(other);
+      }
+      return true;
+    }
+
+    /**
+     * Removes labels from a nogood which are implied by its other labels, except for
+     * the last one
+     */
+    void minimize(std::vector<lit_t> &nogood) {
+      for (lit_t lit : nogood)
+        seen[lit >> 1] = true;
+      std::vector<bool> needed (nogood.size(), true);
+      for (std::size_t i = 0; i + 1 < nogood.size(); i++)
+        needed[i] = !redundant(nogood[i] >> 1, 8);
+      std::size_t kept = 0;
+      for (std::size_t i = 0; i < nogood.size(); i++) {
+        seen[nogood[i] >> 1] = false;
+        if (needed[i])
+          nogood[kept++] = nogood[i];
+      }
+      nogood.resize(kept);
+      for (arg_t arg : touched)
+        state[arg] = UNKNOWN;
+      touched.clear();
+    }
+
+    /**
+     * Derives a nogood from the last conflict. The labels of the highest level
+     * involved are replaced by the labels which implied them, latest first, until a
+     * single one remains (first unique implication point). Search may then jump back
+     * to the highest level among the other labels and revert the remaining one,
+     * unless levels which led to extensions would be skipped.
+     * @param  asserted the label to be reverted
+     * @param  why      the reason for reverting it
+     * @return          the level to jump back to, -1 if search has to backtrack
+     *                  chronologically and -2 if no further extension exists
+     */
+    int analyze(lit_t &asserted, int &why) {
+      std::vector<lit_t> lits, nogood, implied;
+      lits.swap(conflict);
+      int top = 0;
+      for (lit_t lit : lits)
+        top = std::max(top, level_of[lit >> 1]);
+      if (top == 0)
+        return -2;
+
+      std::priority_queue<std::pair<int,arg_t>> open;
+      std::vector<arg_t> marked;
+      auto add = [&](lit_t lit) {
+        const arg_t arg = lit >> 1;
+        if (seen[arg] || level_of[arg] == 0)
+          return;
+        seen[arg] = true;
+        marked.push_back(arg);
+        if (level_of[arg] == top)
+          open.push(std::make_pair(trail_pos[arg], arg));
+        else
+          nogood.push_back(lit);
+      };
+      for (lit_t lit : lits)
+        add(lit);
+      /**
+       * decisions of the highest level which cannot be resolved, flipped decisions
+       * besides the one which opened the level
+       */
+      int unresolved = 0;
+      while (!open.empty()) {
+        const arg_t arg = open.top().second;
+        open.pop();
+        if (open.empty() || reason[arg] == DECIDED) {
+          nogood.push_back(literal(arg, labels[arg]));
+          unresolved++;
+          continue;
+        }
+        implied.clear();
+        explain(arg, implied);
+        for (lit_t lit : implied)
+          add(lit);
+      }
+      for (arg_t arg : marked)
+        seen[arg] = false;
+      minimize(nogood);
+
+      /**
+       * the label to be reverted goes first, the one of the highest remaining level
+       * second
+       */
+      std::size_t first = nogood.size() - 1;
+      std::swap(nogood[0], nogood[first]);
+      int assert_level = 0;
+      for (std::size_t i = 1; i < nogood.size(); i++) {
+        if (level_of[nogood[i] >> 1] > assert_level) {
+          assert_level = level_of[nogood[i] >> 1];
+          std::swap(nogood[1], nogood[i]);
+        }
+      }
+      why = DECIDED;
+      if (nogood_lits < max_nogood_lits) {
+        why = -(int)nogoods.size() - 2;
+        if (nogood.size() <= max_watched_size) {
+          if (watches.empty())
+            watches.resize(2 * n);
+          watches[nogood[0]].push_back(nogoods.size());
+          if (nogood.size() > 1)
+            watches[nogood[1]].push_back(nogoods.size());
+        }
+        nogood_lits += nogood.size();
+        nogoods.push_back(nogood);
+      }
+      asserted = nogood[0];
+      const int target = std::max(assert_level, floor);
+      if (unresolved > 1 || target >= top)
+        return -1;
+      return target;
+    }
+
+    /**
+     * Reverts all labels from a position of the trail on, the logged changes of the
+     * counters are undone in bulk and mismatched is restored
+     * @param pos the position
+     */
+    void revert(int pos) {
+      if (pos < trail.size())
+        mismatched = mismatched_at[pos];
+      const std::uint32_t increased = 2 * n;
+      trail.revert(pos, [this, increased](Trail::change_t change) {
+        const std::uint32_t counter = change >> 1;
+        counters[counter] += counter < increased ? -1 : 1;
+        if (dense && change & 1)
+          bits::erase(range_bits.data(), counter);
+      }, [this](arg_t arg) {
+        labels[arg] = BLANK;
+      });
+      floor = std::min(floor, trail.level());
+      donated_level = std::min(donated_level, trail.level());
+    }
+
+    /**
+     * Sets those arguments IN which are attacked by arguments that have just become
+     * attacked by arg and whose attackers are now all attacked by IN arguments
+     * @param  arg     an argument which has just been set IN
+     * @param  results result builder to which found extensions are reported
+     * @return         false if a stable extension was reached or conflicts occured
+     */
+    bool propagate_dense (arg_t arg, Collector &results) {
+      const int words = ar.bitset_words();
+      const std::size_t base = candidates.size();
+      candidates.resize(base + words, 0);
+      for (arg_t atted : ar.attacked_set(arg))
+        if (pos_range[atted] == 1)
+          bits::unite(&candidates[base], ar.attacked_bits(atted), words);
+      /**
+       * candidates may be reallocated by nested calls, so it is accessed by index
+       */
+      bool consistent = true;
+      for (int i = 0; i < words && consistent; i++)
+        while (consistent && candidates[base + i]) {
+          bits::word_t &word = candidates[base + i];
+          const arg_t cand = 64 * i + __builtin_ctzll(word);
+          word &= word - 1;
+          if (labels[cand] != IN && bits::subset(ar.attacker_bits(cand), range_bits.data(), words)) {
+            if (labels[cand] == OUT)
+              consistent = fail_unattacked(cand);
+            else if (labels[cand] == BLANK)
+              consistent = set_in(cand, indices::BACKTRACK, results, cand);
+          }
+        }
+      candidates.resize(base);
+      return consistent;
+    }
+
+    /**
+     * The IN arguments are stable iff they attack exactly the other arguments
+     */
+    inline bool is_stable() const {return mismatched == 0;}
+
+    /**
+     * Labels arguments before the search starts
+     * @param  path    the labels
+     * @param  results result collector to which found extensions are reported
+     * @return         false if a stable extension was reached or conflicts occured
+     */
+    bool assume(const std::vector<lit_t> &path, Collector &results) {
+      for (lit_t lit : path) {
+        const arg_t arg = lit >> 1;
+        if (labels[arg] == BLANK) {
+          if (lit & 1 ? !set_in(arg, indices::STOP, results) : !set_out(arg, results, indices::STOP))
+            return false;
+        } else if (contradicted(lit)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /**
+     * Gives the subtree below the lowest decision which has not been given away yet
+     * to the pool, i.e. the subtree in which that decision is flipped. The labels
+     * leading there are the decided labels of the lower levels, the flipped label
+     * comes first so that the subtree cannot report extensions of this one.
+     */
+    void donate() {
+      const int donated = ++donated_level;
+      const arg_t decision = trail[trail.level_start(donated)].arg;
+      Subtree subtree {{literal(decision, OUT)}, true};
+      for (arg_t arg = 0; arg < n; arg++)
+        if (labels[arg] != BLANK && reason[arg] == DECIDED && level_of[arg] < donated)
+          subtree.path.push_back(literal(arg, labels[arg]));
+      floor = std::max(floor, donated);
+      pool->give(std::move(subtree));
+    }
+
     /**
      * Lets the algorithm search for stable extensions
-     * @param heuristic a heuirtsic which shall be used
+     * @param order     the policy by which the heuristic is read
      * @param results   result collector to which found extensions are reported
      */
-    void enumStable(Heuristic &heuristic, ExtensionCollector &results) {
+    template <class Order>
+    void enumStable(Order &order, Collector &results) {
 
       /**
-       * Step counter, keeps track of the number of taken decisions
+       * Extensions are only reported after an argument is set IN, which does not
+       * happen in an empty AAF
        */
-      int index = -1;
+      if (n == 0) {
+        results.report_ext_labelling(labels, trail.in_args());
+        return;
+      }
 
       /**
        * Iclude the grounded extension
@@ -180,78 +739,198 @@ namespace {
           return;
       }
 
+      search(order, results);
+    }
+
+    /**
+     * Searches for stable extensions below the current labelling
+     * @param order     the policy by which the heuristic is read
+     * @param results   result collector to which found extensions are reported
+     */
+    template <class Order>
+    void search(Order &order, Collector &results) {
+
+      /**
+       * Step counter, keeps track of the number of taken decisions
+       */
+      int index = -1;
+
       while (true) {
 
        if (++index < n) {
-          arg_t arg = heuristic.get(index, *this);
+          arg_t arg = order.get(index, *this);
           if (labels[arg] & BLANK) {
+              if (pool && pool->wanted > 0 && trail.level() > donated_level)
+                donate();
               if (!set_in(arg, index, results))
                 goto backtrack;
           }
           continue;
         }
+        /**
+         * All arguments are labelled but the IN arguments are not stable, so some OUT
+         * argument is not attacked by any of them
+         */
+        for (arg_t arg = 0; arg < n; arg++) {
+          if (labels[arg] == OUT && pos_range[arg] == 0) {
+            fail_unattacked(arg);
+            break;
+          }
+        }
   backtrack:
-          /**
-           * Pop labelling changes from the stack until a decision is reverted
-           */
           if (results.is_stopped()) {
             break;
           }
-          if (decisions_index.empty()) {
-            break;
+          /**
+           * After a conflict, jump back to the level at which the learned nogood
+           * propagates, reverted decisions are taken again later on
+           */
+          if (!conflict.empty()) {
+            lit_t asserted;
+            int why;
+            const int target = analyze(asserted, why);
+            if (target == -2)
+              break;
+            if (target >= 0) {
+              const int start = trail.level_start(target + 1);
+              index = trail[start].index - 1;
+              revert(start);
+              const arg_t arg = asserted >> 1;
+              if (asserted & 1 ? !set_out(arg, results, indices::BACKTRACK, why)
+                  : !set_in(arg, indices::BACKTRACK, results, why))
+                goto backtrack;
+              continue;
+            }
           }
-          index = decisions_index.top();
-          arg_t arg = decisions_arg.top();
-          decisions_index.pop();
-          decisions_arg.pop();
-          if (index == indices::STOP)
+          /**
+           * Revert the current level and flip its decision, no decision is left to
+           * be flipped at level 0
+           */
+          if (trail.level() == 0) {
             break;
-          if (labels[arg] == IN) {
-            for (arg_t a : ar.attacker_set(arg)) {
-              neg_range[a] --;
-            }
-            for (arg_t a : ar.attacked_set(arg)) {
-              pos_range[a] --;
-              if (pos_range[a] == 0)
-                for (arg_t attedatted : ar.attacked_set(a)) {
-                  agressor_cnt[attedatted]++;
-                }
-            }
           }
-          labels[arg] = BLANK;
-          if (index == indices::BACKTRACK || !set_out(arg, results)) {
+          const int start = trail.level_start(trail.level());
+          const arg_t arg = trail[start].arg;
+          const bool donated = trail.level() <= donated_level;
+          index = trail[start].index;
+          revert(start);
+          if (donated || !set_out(arg, results)) {
             goto backtrack;
           }
       }
     }
   };
 
+  /**
+   * Enumerates stable extensions with several threads. Every thread keeps its own
+   * labelling and counters and searches open subtrees until none are left.
+   * @param ar        the underlying AAF as an attack relation
+   * @param order     the order of a static heuristic, which is shared by the threads
+   * @param threads   the number of threads
+   * @param path      labels which all reported extensions contain
+   * @param results   result collector to which found extensions are reported
+   */
+  template <class Order>
+  void enumParallel(const AttackRelation &ar, Order order, int threads,
+      const std::vector<lit_t> &path, ExtensionCollector &results) {
+    SharedCollector shared {results};
+    WorkPool pool {threads, shared};
+    pool.give(Subtree {path, false});
+    auto work = [&]() {
+      Subtree subtree;
+      Order local = order;
+      while (pool.take(subtree)) {
+        StableEnumerator<SharedCollector> enumerator {ar, false, &pool};
+        if (!enumerator.assume(subtree.path, shared))
+          continue;
+        if (subtree.prepared)
+          enumerator.search(local, shared);
+        else
+          enumerator.enumStable(local, shared);
+      }
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threads; i++)
+      workers.emplace_back(work);
+    work();
+    for (auto &worker : workers)
+      worker.join();
+  }
+
+  /**
+   * Enumerates the stable extensions which contain some labels. The search is
+   * instantiated for the type of the collector and the order policy which fits the
+   * heuristic, a static heuristic is searched in parallel if several threads are
+   * given.
+   * @param ar        the underlying AAF as an attack relation
+   * @param heuristic the heuristic
+   * @param threads   the number of threads
+   * @param path      labels which all reported extensions contain
+   * @param results   result collector to which found extensions are reported
+   */
+  template <class Collector>
+  void enumerate(const AttackRelation &ar, Heuristic &heuristic, int threads,
+      const std::vector<lit_t> &path, Collector &results) {
+    const bool dynamic = heuristic.is_dynamic();
+    if (threads > 1 && !dynamic) {
+      if (heuristic.is_const())
+        enumParallel(ar, IdentityOrder {}, threads, path, results);
+      else
+        enumParallel(ar, StaticOrder {heuristic}, threads, path, results);
+      return;
+    }
+    StableEnumerator<Collector> enumerator {ar, dynamic};
+    if (!enumerator.assume(path, results))
+      return;
+    if (dynamic) {
+      DynamicOrder order {heuristic};
+      enumerator.enumStable(order, results);
+    } else if (heuristic.is_const()) {
+      IdentityOrder order;
+      enumerator.enumStable(order, results);
+    } else {
+      StaticOrder order {heuristic};
+      enumerator.enumStable(order, results);
+    }
+  }
+
 }
 
-std::vector<std::vector<int>> StableSolver::enum_exts(const AttackRelation &ar, int max_cnt) {
-  ExtensionEnumerator results {max_cnt};
-  StableEnumerator enumerator {ar};
-  enumerator.enumStable(heuristic, results);
+ExtensionStore StableSolver::enum_exts(const AttackRelation &ar, int max_cnt) {
+  ExtensionEnumerator results {ar.arg_cnt, max_cnt};
+  results.cancel_with(cancelled);
+  enumerate(ar, heuristic, threads, {}, results);
   return results.exts;
 }
 
 
 
+std::uint64_t StableSolver::count_exts(const AttackRelation &ar) {
+  ExtensionCounter results;
+  results.cancel_with(cancelled);
+  enumerate(ar, heuristic, threads, {}, results);
+  return results.count;
+}
+
+void StableSolver::report_exts(const AttackRelation &ar, ExtensionCollector &results) {
+  /**
+   * EE prints every extension, so the search is instantiated for the printer to
+   * bind its reports at compile time
+   */
+  if (ExtensionPrinter *printer = dynamic_cast<ExtensionPrinter*>(&results))
+    enumerate(ar, heuristic, threads, {}, *printer);
+  else
+    enumerate(ar, heuristic, threads, {}, results);
+}
+
 bool StableSolver::justify (const AttackRelation &ar, arg_t arg, bool sceptical) {
   ArgumentJustifier results {arg, sceptical};
-  StableEnumerator enumerator {ar};
+  results.cancel_with(cancelled);
   /**
    * For sceptical justification only extensions which do not contain the respective
-   * argument are relevant and for credulous justification only those which do not
+   * argument are relevant and for credulous justification only those which do
    * contain it
    */
-  if (sceptical) {
-    if(!enumerator.set_out(arg, results, indices::STOP))
-      return results.is_justified();
-  } else {
-    if(!enumerator.set_in(arg, indices::STOP, results))
-      return results.is_justified();
-  }
-  enumerator.enumStable(heuristic, results);
+  enumerate(ar, heuristic, threads, {literal(arg, sceptical ? OUT : IN)}, results);
   return results.is_justified();
 }
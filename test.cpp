@@ -1,10 +1,162 @@
 #include "test.h"
 #include "AAF.h"
 #include "algebra.h"
-#include "heuristic.h"
+#include "solver.h"
+#include "binary.h"
 
 #include <iostream>
 #include <fstream>
+#include <chrono>
+#include <random>
+#include <functional>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+namespace {
+  /**
+   * the number of failed checks
+   */
+  int failures = 0;
+
+  /**
+   * Reports a failed check
+   * @param passed whether the check passed
+   * @param what   describes the check
+   */
+  void check(bool passed, const std::string &what) {
+    if (!passed) {
+      failures++;
+      std::cout << "FAILED " << what << std::endl;
+    }
+  }
+
+  /**
+   * Enumerates the extensions of a solver
+   * @param  solver the solver
+   * @param  ar     the attack relation
+   * @param  ms     set to the milliseconds the enumeration took
+   * @return        the extensions as sorted ids in lexicographic order
+   */
+  std::vector<std::vector<int>> sorted_exts(Solver &solver, const AttackRelation &ar, long &ms) {
+    using namespace std::chrono;
+    auto start = high_resolution_clock::now();
+    std::vector<std::vector<int>> exts = solver.enum_exts(ar);
+    ms = duration_cast<milliseconds>(high_resolution_clock::now() - start).count();
+    std::sort(exts.begin(), exts.end());
+    return exts;
+  }
+
+  std::vector<std::vector<int>> sorted_exts(Solver &solver, const AttackRelation &ar) {
+    long ms;
+    return sorted_exts(solver, ar, ms);
+  }
+
+  /**
+   * Enumerates extensions by testing every set of arguments, for at most 16 arguments
+   * @param  ar        the attack relation
+   * @param  semantics the semantics
+   * @return           the extensions as sorted ids in lexicographic order
+   */
+  std::vector<std::vector<int>> reference_exts(const AttackRelation &ar, SCCSolver::semantics_t semantics) {
+    const int n = ar.arg_cnt;
+    const std::uint32_t all = (std::uint32_t(1) << n) - 1;
+    std::vector<std::uint32_t> attackers (n);
+    for (int i = 0; i < n; i++)
+      for (arg_t atter : ar.attacker_set(i))
+        attackers[i] |= std::uint32_t(1) << atter;
+    std::vector<std::uint32_t> found;
+    for (std::uint32_t set = 0; set <= all; set++) {
+      std::uint32_t attacked = 0, defended = 0;
+      for (int i = 0; i < n; i++)
+        if (attackers[i] & set)
+          attacked |= std::uint32_t(1) << i;
+      for (int i = 0; i < n; i++)
+        if (!(attackers[i] & ~attacked))
+          defended |= std::uint32_t(1) << i;
+      if (attacked & set)
+        continue;
+      if (semantics == SCCSolver::STABLE ? (set | attacked) == all
+          : semantics == SCCSolver::COMPLETE ? defended == set : !(set & ~defended))
+        found.push_back(set);
+    }
+    // the preferred extensions are the maximal admissible sets
+    if (semantics == SCCSolver::PREFERRED)
+      found.erase(std::remove_if(found.begin(), found.end(), [&found](std::uint32_t set) {
+        return std::any_of(found.begin(), found.end(), [set](std::uint32_t other) {
+          return other != set && (other & set) == set;
+        });
+      }), found.end());
+    std::vector<std::vector<int>> exts;
+    for (std::uint32_t set : found) {
+      exts.emplace_back();
+      for (int i = 0; i < n; i++)
+        if (set >> i & 1)
+          exts.back().push_back(i);
+    }
+    std::sort(exts.begin(), exts.end());
+    return exts;
+  }
+
+  /**
+   * Computes the grounded extension by applying the characteristic function until
+   * it reaches its least fixpoint
+   */
+  std::vector<int> reference_grounded(const AttackRelation &ar) {
+    const int n = ar.arg_cnt;
+    std::vector<bool> in (n, false), out (n, false);
+    for (bool changed = true; changed; ) {
+      changed = false;
+      for (int i = 0; i < n; i++) {
+        bool defended = true, defeated = false;
+        for (arg_t atter : ar.attacker_set(i)) {
+          defended = defended && out[atter];
+          defeated = defeated || in[atter];
+        }
+        if ((defended && !in[i]) || (defeated && !out[i])) {
+          in[i] = in[i] || defended;
+          out[i] = out[i] || defeated;
+          changed = true;
+        }
+      }
+    }
+    std::vector<int> ext;
+    for (int i = 0; i < n; i++)
+      if (in[i])
+        ext.push_back(i);
+    return ext;
+  }
+
+  /**
+   * Computes a power digit by digit
+   * @param  base a base below 10
+   * @param  exp  the exponent
+   * @return      the power in decimal notation
+   */
+  std::string decimal_power(int base, int exp) {
+    // least significant digit first
+    std::string digits = "1";
+    for (int i = 0; i < exp; i++) {
+      int carry = 0;
+      for (char &digit : digits) {
+        const int value = (digit - '0') * base + carry;
+        digit = '0' + value % 10;
+        carry = value / 10;
+      }
+      for (; carry; carry /= 10)
+        digits += '0' + carry % 10;
+    }
+    return std::string(digits.rbegin(), digits.rend());
+  }
+
+  /**
+   * Creates the solvers for count_by_components
+   */
+  Solver * create_stable(Heuristic &heuristic) {return new StableSolver(heuristic);}
+  Solver * create_complete(Heuristic &heuristic) {return new CompleteSolver(heuristic);}
+  Solver * create_preferred(Heuristic &heuristic) {return new PreferredSolver(heuristic);}
+}
 
 void print(std::vector<int> v){
   for (int i = 0; i< v.size();i++)
@@ -17,10 +169,10 @@ extern std::vector<float> betweenness_centrality(AttackRelation &ar);
 extern std::vector<int> compute_sccs(const AttackRelation&ar);
 
 void SCCTest() {
-  AAF aaf = {
-   {{0,"a"}, {1,"b"} ,{2,"c"},{3,"e"},{4,"d"},{5,"f"}},
-   {{{0,"a"}, {1,"b"}},{{1,"b"}, {0,"a"}},{{3,"e"}, {0,"a"}}, {{0,"a"}, {3,"e"}}, {{4,"d"}, {2,"c"}}, {{4,"d"}, {5,"f"}}, {{5,"f"}, {4,"d"}}}
- };
+  AAF aaf;
+  for (auto label : {"a", "b", "c", "e", "d", "f"})
+    aaf.add_argument(label);
+  aaf.atts = {{0,1}, {1,0}, {3,0}, {0,3}, {4,2}, {4,5}, {5,4}};
 
  //std::cerr << aaf << std::endl;
   AttackRelation ar (aaf);
@@ -33,10 +185,10 @@ void SCCTest() {
 }
 
 void PowerIterationTest () {
-  AAF aaf = {
-   {{0,"a"}, {1,"b"} ,{2,"c"}},
-   {{{0,"a"}, {1,"b"}},{{1,"b"}, {0,"a"}}}
- };
+  AAF aaf;
+  for (auto label : {"a", "b", "c"})
+    aaf.add_argument(label);
+  aaf.atts = {{0,1}, {1,0}};
  std::cerr << aaf << std::endl;
   int n = aaf.args.size();
   Eigen::SparseMatrix<float> A(n,n);
@@ -53,10 +205,457 @@ void PowerIterationTest () {
 
 
 
-void test() {
+/**
+ * Compares the compressed sparse row layout of AttackRelation with the former layout
+ * of one vector per argument regarding construction time, traversal time and memory
+ */
+void AttackRelationBenchmark() {
+  using namespace std::chrono;
+  const int n = 200000, m = 2000000, rounds = 5;
+  std::mt19937 rand(42);
+  std::uniform_int_distribution<int> dist(0, n - 1);
+  std::vector<Attack> atts;
+  for (int i = 0; i < m; i++)
+    atts.push_back({dist(rand), dist(rand)});
+
+  auto ms_since = [](high_resolution_clock::time_point start) {
+    return duration_cast<milliseconds>(high_resolution_clock::now() - start).count();
+  };
+  // sums over attackers of attacked arguments, the access pattern of set_in
+  auto traverse = [n, rounds](std::function<long(int)> visit) {
+    long sum = 0;
+    for (int r = 0; r < rounds; r++)
+      for (int i = 0; i < n; i++)
+        sum += visit(i);
+    return sum;
+  };
+
+  auto start = high_resolution_clock::now();
+  std::vector<std::vector<int>> atters (n), atteds (n);
+  for (auto &att : atts) {
+    atters[att.passive].push_back(att.active);
+    atteds[att.active].push_back(att.passive);
+  }
+  auto nested_construction = ms_since(start);
+  start = high_resolution_clock::now();
+  long nested_sum = traverse([&](int i) {
+    long sum = 0;
+    for (int atted : atteds[i])
+      for (int atter : atters[atted])
+        sum += atter;
+    return sum;
+  });
+  auto nested_traversal = ms_since(start);
+  std::size_t nested_bytes = 2 * n * sizeof(std::vector<int>);
+  for (int i = 0; i < n; i++) {
+    // every allocation costs at least a malloc header of 16 bytes
+    nested_bytes += 4 * (atters[i].capacity() + atteds[i].capacity())
+      + 16 * (!!atters[i].capacity() + !!atteds[i].capacity());
+  }
+
+  start = high_resolution_clock::now();
+  AttackRelation ar (n, atts);
+  auto csr_construction = ms_since(start);
+  start = high_resolution_clock::now();
+  long csr_sum = traverse([&](int i) {
+    long sum = 0;
+    for (int atted : ar.attacked_set(i))
+      for (int atter : ar.attacker_set(atted))
+        sum += atter;
+    return sum;
+  });
+  auto csr_traversal = ms_since(start);
+  std::size_t csr_bytes = 2 * (n + 1) * sizeof(std::uint64_t) + 2 * ar.attack_cnt() * sizeof(arg_t);
+
+  std::cout << "layout\tbuild\ttraverse\tmemory\tchecksum" << std::endl
+    << "nested\t" << nested_construction << "ms\t" << nested_traversal << "ms\t"
+    << nested_bytes / 1024 << "KiB\t" << nested_sum << std::endl
+    << "csr\t" << csr_construction << "ms\t" << csr_traversal << "ms\t"
+    << csr_bytes / 1024 << "KiB\t" << csr_sum << std::endl;
+}
+
+/**
+ * Compares the stable solver on adjacency lists and on bitsets for a dense AAF
+ */
+void BitsetStableBenchmark() {
+  using namespace std::chrono;
+  const int n = 200;
+  std::mt19937 rand(42);
+  std::bernoulli_distribution attacks(0.3), planted(0.1);
+  // every fourth argument belongs to a planted stable extension
+  std::vector<Attack> atts;
+  for (int i = 0; i < n; i++)
+    for (int j = 0; j < n; j++)
+      if (i % 4 ? attacks(rand) : j % 4 && planted(rand))
+        atts.push_back({i, j});
+  for (int j = 1; j < n; j++)
+    if (j % 4)
+      atts.push_back({j / 4 * 4, j});
+
+  AttackRelation sparse (n, atts), dense (sparse);
+  dense.build_bitsets();
+  ExtendedDegreeRatioHeuristic heuristic (sparse);
+  heuristic.sort();
+
+  StableSolver solver (heuristic);
+  long sparse_ms, dense_ms;
+  auto sparse_exts = sorted_exts(solver, sparse, sparse_ms),
+    dense_exts = sorted_exts(solver, dense, dense_ms);
+
+  std::cout << "backend\tEE-ST" << std::endl
+    << "sparse\t" << sparse_ms << "ms\t" << sparse_exts.size() << " extensions" << std::endl
+    << "dense\t" << dense_ms << "ms\t" << dense_exts.size() << " extensions" << std::endl;
+  check(sparse_exts == dense_exts, "bitset benchmark: dense and sparse EE-ST differ");
+}
+
+void GroundedUpdateBenchmark() {
+  using namespace std::chrono;
+  const int n = 200000;
+  std::mt19937 rand(7);
+  std::uniform_int_distribution<int> any(0, n - 1);
+  std::vector<Attack> atts;
+  for (int i = 0; i < 2 * n; i++)
+    atts.push_back({any(rand), any(rand)});
+  AttackRelation ar (n, atts);
+
+  GroundedSolver incremental;
+  incremental.find_ext(ar);
+  long update_us = 0, recompute_us = 0;
+  bool match = true;
+  for (int i = 0; i < 100; i++) {
+    const int a = any(rand) % ar.arg_cnt, b = any(rand) % ar.arg_cnt;
+    if (i % 25 == 24)
+      ar.remove_argument(a);
+    else if (i % 25 == 12)
+      ar.add_attack(ar.add_argument(), b);
+    else if (i % 2)
+      ar.add_attack(a, b);
+    else if (!ar.attacker_set(b).empty())
+      ar.remove_attack(ar.attacker_set(b)[0], b);
+
+    auto start = high_resolution_clock::now();
+    auto ext = incremental.find_ext(ar);
+    auto mid = high_resolution_clock::now();
+    auto expected = GroundedSolver().find_ext(ar);
+    auto end = high_resolution_clock::now();
+    update_us += duration_cast<microseconds>(mid - start).count();
+    recompute_us += duration_cast<microseconds>(end - mid).count();
+    match = match && ext == expected;
+  }
+
+  std::cout << "grounded after 100 updates" << std::endl
+    << "incremental\t" << update_us / 1000 << "ms" << std::endl
+    << "recompute\t" << recompute_us / 1000 << "ms" << std::endl;
+  check(match, "grounded benchmark: incremental and recomputed extension differ");
+}
+
+/**
+ * Compares the preferred solver on a layered AAF with and without solving it SCC by
+ * SCC
+ */
+void SCCSolverBenchmark() {
+  using namespace std::chrono;
+  const int layers = 16, width = 6;
+  std::mt19937 rand(3);
+  std::bernoulli_distribution inner(0.1), outer(0.1);
+  // every layer is a cycle with chords, which attacks the next layer
+  std::vector<Attack> atts;
+  for (int l = 0; l < layers; l++)
+    for (int i = 0; i < width; i++) {
+      const int arg = l * width + i;
+      atts.push_back({arg, l * width + (i + 1) % width});
+      for (int j = 0; j < width; j++)
+        if (inner(rand))
+          atts.push_back({arg, l * width + j});
+      if (l + 1 < layers)
+        for (int j = 0; j < width; j++)
+          if (outer(rand))
+            atts.push_back({arg, (l + 1) * width + j});
+    }
+  AttackRelation ar (layers * width, atts);
+  ExtendedDegreeRatioHeuristic heuristic (ar);
+  heuristic.sort();
+
+  PreferredSolver whole (heuristic);
+  SCCSolver scc (SCCSolver::PREFERRED, heuristic);
+  long whole_ms, scc_ms;
+  auto whole_exts = sorted_exts(whole, ar, whole_ms), scc_exts = sorted_exts(scc, ar, scc_ms);
+
+  std::cout << "solver\tEE-PR" << std::endl
+    << "whole\t" << whole_ms << "ms\t" << whole_exts.size() << " extensions" << std::endl
+    << "scc\t" << scc_ms << "ms\t" << scc_exts.size() << " extensions" << std::endl;
+  check(whole_exts == scc_exts, "scc benchmark: EE-PR differs from the whole AAF");
+}
+
+/**
+ * Writes an AAF in the binary format, corrupts single sections of the file and
+ * checks that loading rejects corrupt attacks and drops corrupt analyses
+ */
+void BinaryLoadTest() {
+  AAF aaf;
+  for (auto label : {"a", "b", "c", "d"})
+    aaf.add_argument(label);
+  aaf.atts = {{0,1}, {1,2}, {2,3}, {3,2}};
+  AttackRelation ar (aaf);
+  ar.analysis.grounded = {0};
+  ar.analysis.has_grounded = true;
+  ar.analysis.sccs = compute_sccs(ar);
+  ar.analysis.orders["order"] = {{3, 4.}, {2, 3.}, {1, 2.}, {0, 1.}};
+
+  const std::string path = "heureka_test.bin";
+  if (!writeBinary(path, aaf, ar)) {
+    check(false, "binary: write " + path);
+    return;
+  }
+  std::string bytes;
+  {
+    std::ifstream in (path, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  /**
+   * Finds the data of a section by the layout of the header and the section table
+   */
+  auto section_data = [&bytes](std::uint32_t type) -> char * {
+    std::uint32_t section_cnt;
+    std::memcpy(&section_cnt, &bytes[12], 4);
+    for (std::uint32_t i = 0; i < section_cnt; i++) {
+      const char *entry = &bytes[32 + 24 * i];
+      std::uint32_t section_type;
+      std::uint64_t offset;
+      std::memcpy(&section_type, entry, 4);
+      std::memcpy(&offset, entry + 8, 8);
+      if (section_type == type)
+        return &bytes[offset];
+    }
+    return nullptr;
+  };
+  /**
+   * Loads the file after applying a corruption to a copy of it
+   */
+  auto load = [&](std::function<void()> corrupt) {
+    const std::string original = bytes;
+    corrupt();
+    {
+      std::ofstream out (path, std::ios::binary);
+      out.write(bytes.data(), bytes.size());
+    }
+    bytes = original;
+    AAF loaded;
+    return std::unique_ptr<AttackRelation>(loadBinary(loaded, path));
+  };
+  auto put_int = [](char *data, std::int32_t val) {std::memcpy(data, &val, 4);};
+
+  auto intact = load([]{});
+  check(intact && intact->analysis.has_grounded && intact->analysis.grounded == ar.analysis.grounded
+    && intact->analysis.sccs == ar.analysis.sccs && intact->analysis.orders == ar.analysis.orders,
+    "binary: load intact file");
+
+  auto grounded = load([&]{put_int(section_data(4), 4);});
+  check(grounded && !grounded->analysis.has_grounded, "binary: drop grounded id out of range");
+  auto sccs = load([&]{put_int(section_data(5) + 4, -1);});
+  check(sccs && sccs->analysis.sccs.empty(), "binary: drop scc id out of range");
+  // the expression takes 16 bytes, each entry 16 bytes
+  auto order = load([&]{put_int(section_data(6) + 8 + 8 + 16, 3);});
+  check(order && order->analysis.orders.empty(), "binary: drop order which is no permutation");
+  // b is attacked by a, the attackers half claims d behind the 5 offsets
+  auto transposed = load([&]{put_int(section_data(2) + 8 * 5, 3);});
+  check(!transposed, "binary: reject attacker half which disagrees with attacked half");
+  std::remove(path.c_str());
+}
+
+/**
+ * Compares the solvers with reference_exts on small random AAFs: the stable solver
+ * with nogood learning on adjacency lists, on bitsets and with work stealing, the
+ * complete and preferred solvers and the SCC solver for every semantics
+ */
+void ReferenceTest() {
+  std::mt19937 rand(11);
+  for (int round = 0; round < 400; round++) {
+    const int n = 1 + round % 14;
+    std::bernoulli_distribution attacks(0.05 + 0.05 * (round % 7));
+    std::vector<Attack> atts;
+    std::string instance = "random AAF " + std::to_string(round) + " with attacks";
+    for (int i = 0; i < n; i++)
+      for (int j = 0; j < n; j++)
+        if (attacks(rand) && (i != j || round % 3 == 0)) {
+          atts.push_back({i, j});
+          instance += " " + std::to_string(i) + "->" + std::to_string(j);
+        }
+    AttackRelation ar (n, atts), dense (ar);
+    dense.build_bitsets();
+    ExtendedDegreeRatioHeuristic heuristic (ar);
+    heuristic.sort();
+    ConstHeuristic identity (0, n);
+    std::vector<std::pair<int, rational_t>> reversed;
+    for (int i = n - 1; i >= 0; i--)
+      reversed.push_back(std::pair<int, rational_t>(i, 0));
+    PrecomputedHeuristic reverse (reversed);
+
+    StableSolver stable (heuristic), stable_identity (identity), stable_parallel (heuristic, 3);
+    CompleteSolver complete (heuristic);
+    PreferredSolver preferred (heuristic);
+    SCCSolver scc_stable (SCCSolver::STABLE, heuristic), scc_complete (SCCSolver::COMPLETE, heuristic),
+      scc_preferred (SCCSolver::PREFERRED, heuristic);
+    PortfolioSolver stable_portfolio ({new StableSolver(heuristic), new StableSolver(identity),
+        new StableSolver(reverse)}),
+      preferred_portfolio ({new PreferredSolver(heuristic), new PreferredSolver(identity),
+        new PreferredSolver(reverse)});
+    struct {
+      std::string name;
+      Solver &solver;
+      const AttackRelation &ar;
+      SCCSolver::semantics_t semantics;
+    } cases[] = {
+      {"stable", stable, ar, SCCSolver::STABLE},
+      {"stable in id order", stable_identity, ar, SCCSolver::STABLE},
+      {"stable on bitsets", stable, dense, SCCSolver::STABLE},
+      {"stable with 3 threads", stable_parallel, ar, SCCSolver::STABLE},
+      {"complete", complete, ar, SCCSolver::COMPLETE},
+      {"preferred", preferred, ar, SCCSolver::PREFERRED},
+      {"scc stable", scc_stable, ar, SCCSolver::STABLE},
+      {"scc complete", scc_complete, ar, SCCSolver::COMPLETE},
+      {"scc preferred", scc_preferred, ar, SCCSolver::PREFERRED},
+      {"stable portfolio", stable_portfolio, ar, SCCSolver::STABLE},
+      {"preferred portfolio", preferred_portfolio, ar, SCCSolver::PREFERRED},
+    };
+    for (auto &c : cases) {
+      const auto expected = reference_exts(ar, c.semantics);
+      check(sorted_exts(c.solver, c.ar) == expected, c.name + " enumeration on " + instance);
+      check(c.solver.count_exts(c.ar) == expected.size(), c.name + " count on " + instance);
+      const std::vector<std::vector<int>> single = c.solver.enum_exts(c.ar, 1);
+      check(expected.empty() ? single.empty()
+          : single.size() == 1 && std::binary_search(expected.begin(), expected.end(), single[0]),
+        c.name + " single extension on " + instance);
+      for (int arg = 0; arg < n; arg++) {
+        int containing = 0;
+        for (auto &ext : expected)
+          containing += std::binary_search(ext.begin(), ext.end(), arg);
+        check(c.solver.justify(c.ar, arg, false) == (containing > 0),
+          c.name + " credulous acceptance of " + std::to_string(arg) + " on " + instance);
+        check(c.solver.justify(c.ar, arg, true) == (containing == (int)expected.size()),
+          c.name + " sceptical acceptance of " + std::to_string(arg) + " on " + instance);
+      }
+    }
+    check(GroundedSolver().find_ext(ar) == reference_grounded(ar), "grounded on " + instance);
+    const struct {
+      std::string name;
+      Solver * (*create)(Heuristic &);
+      SCCSolver::semantics_t semantics;
+    } counts[] = {
+      {"stable", create_stable, SCCSolver::STABLE},
+      {"complete", create_complete, SCCSolver::COMPLETE},
+      {"preferred", create_preferred, SCCSolver::PREFERRED},
+    };
+    for (auto &c : counts) {
+      const std::string expected = std::to_string(reference_exts(ar, c.semantics).size());
+      check(count_by_components(ar, heuristic, c.create) == expected,
+        c.name + " count by components on " + instance);
+      check(count_by_components(dense, heuristic, c.create) == expected,
+        c.name + " count by components on bitsets on " + instance);
+    }
+  }
+}
+
+/**
+ * Counts the extensions of k disjoint pairs of mutually attacking arguments by
+ * components. There are 2^k stable and preferred and 3^k complete extensions,
+ * which exceed 64 bits for the larger k and then need digit groups with leading
+ * zeros, e.g. 2^97 and 3^65.
+ */
+void ComponentCountTest() {
+  for (int k : {1, 64, 65, 70, 97}) {
+    std::vector<Attack> atts;
+    for (int i = 0; i < 2 * k; i += 2) {
+      atts.push_back({i, i + 1});
+      atts.push_back({i + 1, i});
+    }
+    AttackRelation ar (2 * k, atts);
+    ExtendedDegreeRatioHeuristic heuristic (ar);
+    heuristic.sort();
+    const std::string instance = std::to_string(k) + " disjoint 2-cycles";
+    check(count_by_components(ar, heuristic, create_stable) == decimal_power(2, k),
+      "stable count by components on " + instance);
+    check(count_by_components(ar, heuristic, create_complete) == decimal_power(3, k),
+      "complete count by components on " + instance);
+    check(count_by_components(ar, heuristic, create_preferred) == decimal_power(2, k),
+      "preferred count by components on " + instance);
+  }
+}
+
+/**
+ * Compares the stable solver with work stealing with the sequential one on AAFs
+ * whose searches take long enough that threads give away subtrees: pairs of
+ * mutually attacking arguments with random attacks among them
+ */
+void WorkStealingTest() {
+  const int n = 48;
+  std::mt19937 rand(13);
+  std::uniform_int_distribution<int> any(0, n - 1);
+  for (int round = 0; round < 6; round++) {
+    std::vector<Attack> atts;
+    for (int i = 0; i < n; i += 2) {
+      atts.push_back({i, i + 1});
+      atts.push_back({i + 1, i});
+    }
+    for (int i = 0; i < n / 4 + 4 * round; i++)
+      atts.push_back({any(rand), any(rand)});
+    AttackRelation ar (n, atts);
+    ExtendedDegreeRatioHeuristic heuristic (ar);
+    heuristic.sort();
+    StableSolver sequential (heuristic);
+    const auto expected = sorted_exts(sequential, ar);
+    for (int threads : {2, 4}) {
+      StableSolver parallel (heuristic, threads);
+      const std::string instance = std::to_string(threads) + " threads on AAF " + std::to_string(round);
+      check(sorted_exts(parallel, ar) == expected, "stable enumeration with " + instance);
+      check(parallel.count_exts(ar) == expected.size(), "stable count with " + instance);
+    }
+  }
+}
+
+/**
+ * Compares the grounded extension computed by several threads with the reference
+ * on AAFs which are large enough to be split among the threads
+ */
+void ParallelGroundedTest() {
+  const int n = 1 << 16;
+  std::mt19937 rand(5);
+  std::uniform_int_distribution<int> any(0, n - 1);
+  for (int degree : {1, 2, 3}) {
+    std::vector<Attack> atts;
+    for (int i = 0; i < degree * n; i++)
+      atts.push_back({any(rand), any(rand)});
+    AttackRelation ar (n, atts);
+    check(GroundedSolver(4).find_ext(ar) == reference_grounded(ar),
+      "grounded with 4 threads on random AAF with " + std::to_string(degree * n) + " attacks");
+  }
+}
+
+int test() {
 
  SCCTest();
 
+ AttackRelationBenchmark();
+
+ BitsetStableBenchmark();
+
+ GroundedUpdateBenchmark();
+
+ SCCSolverBenchmark();
+
   //PowerIterationTest();
 
+ BinaryLoadTest();
+
+ ReferenceTest();
+
+ ComponentCountTest();
+
+ WorkStealingTest();
+
+ ParallelGroundedTest();
+
+ if (failures)
+   std::cout << failures << " checks failed" << std::endl;
+ return failures;
 }
@@ -1 +1,5 @@
-void test();
+/**
+ * Runs the tests and benchmarks
+ * @return the number of failed checks
+ */
+int test();
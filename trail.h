@@ -0,0 +1,140 @@
+#include "AAF.h"
+
+#include <vector>
+#include <cstdint>
+
+#pragma once
+
+/**
+ * The labels taken by a backtracking algorithm in the order in which they were
+ * taken. Every entry holds the labelled argument, the algorithm step counter at
+ * which it was labelled, a non-negative counter marks a decision, and the length of
+ * the change log when it was labelled. Since every argument is labelled at most
+ * once, memory for all arguments is allocated up front. The positions of the
+ * decisions mark the decision levels, so that all labels of a level can be reverted
+ * at once. The arguments labelled IN are listed separately in the same order, so an
+ * extension is read off without scanning all labels.
+ *
+ * Algorithms log every change of a counter which a label causes, packed into a
+ * single word each (see change_t). Reverting labels undoes the changes logged since
+ * then in bulk by reading the log backwards instead of walking the neighbourhoods
+ * of the reverted arguments again. The log of a single label can also be read
+ * while propagating it. Its length is bounded by the algorithm, so it is allocated
+ * up front as well.
+ */
+class Trail {
+public:
+  /**
+   * A logged change, the position of the counter among all counters of the
+   * algorithm shifted left by one and a flag in the lowest bit which the algorithm
+   * may use to mark special changes
+   */
+  typedef std::uint32_t change_t;
+
+  struct Entry {
+    arg_t arg;
+    int index;
+    std::uint32_t changes;
+  };
+private:
+  std::vector<Entry> entries;
+  std::vector<int> decisions;
+  std::vector<arg_t> ins;
+  change_t *changes, *changes_end;
+public:
+  /**
+   * @param n           the number of arguments
+   * @param max_changes the number of changes which may be logged at once
+   */
+  Trail(int n, std::size_t max_changes) {
+    changes = changes_end = new change_t[max_changes];
+    entries.reserve(n);
+    decisions.reserve(n);
+    ins.reserve(n);
+  }
+  ~Trail() {delete[] changes;}
+  Trail(const Trail&) = delete;
+
+  /**
+   * @param arg   the labelled argument
+   * @param index the algorithm step counter
+   * @param in    whether the argument is labelled IN
+   */
+  inline void push(arg_t arg, int index, bool in = false) {
+    if (index >= 0)
+      decisions.push_back(entries.size());
+    entries.push_back(Entry {arg, index, (std::uint32_t)(changes_end - changes)});
+    if (in)
+      ins.push_back(arg);
+  }
+
+  /**
+   * Logs a change of a counter caused by the last label
+   * @param counter the position of the counter
+   * @param flag    the flag of the change
+   */
+  inline void log(std::uint32_t counter, bool flag = false) {
+    *changes_end++ = counter << 1 | flag;
+  }
+
+  /**
+   * @return the number of logged changes
+   */
+  inline std::size_t logged() const {return changes_end - changes;}
+  /**
+   * @param  i the position of a change in the log
+   * @return   the change
+   */
+  inline change_t change(std::size_t i) const {return changes[i];}
+
+  /**
+   * Pops all labels from a position on
+   * @param pos    the position
+   * @param undo   called with every change logged since the label at pos, latest
+   *               first
+   * @param revert called with every popped argument, latest first
+   */
+  template <class Undo, class Revert>
+  inline void revert(int pos, Undo undo, Revert revert) {
+    if (pos >= size())
+      return;
+    const std::size_t first = entries[pos].changes;
+    while (changes_end != changes + first)
+      undo(*--changes_end);
+    while (size() > pos)
+      revert(pop().arg);
+  }
+
+  /**
+   * Pops the last label, since every argument is on the trail at most once, it was
+   * an IN label iff its argument is the last one listed
+   */
+  inline Entry pop() {
+    const Entry entry = entries.back();
+    entries.pop_back();
+    if (entry.index >= 0)
+      decisions.pop_back();
+    if (!ins.empty() && ins.back() == entry.arg)
+      ins.pop_back();
+    return entry;
+  }
+
+  inline const Entry & top() const {return entries.back();}
+  inline const Entry & operator[](int pos) const {return entries[pos];}
+  inline int size() const {return entries.size();}
+  inline bool empty() const {return entries.empty();}
+  /**
+   * @return the arguments labelled IN in the order in which they were labelled
+   */
+  inline const std::vector<arg_t> &in_args() const {return ins;}
+
+  /**
+   * @return the number of decisions on the trail
+   */
+  inline int level() const {return decisions.size();}
+  /**
+   * @param  level a decision level above 0
+   * @return       the position of the decision which opened the level
+   */
+  inline int level_start(int level) const {return decisions[level - 1];}
+};